@@ -27,7 +27,7 @@ function(project_antlr_library namespace lib grammar jar)
     # prepare all variables
     #
 
-    cmake_parse_arguments(PARSE_ARGV 4 arg "LISTENER VISITOR" "" "")
+    cmake_parse_arguments(PARSE_ARGV 4 arg "LISTENER VISITOR WALKER NO_VERIFY SHARED_CACHE" "" "")
 
     get_filename_component(jar_dir "${jar}" DIRECTORY)
 
@@ -53,6 +53,12 @@ function(project_antlr_library namespace lib grammar jar)
         unset(visitor_cpp)
     endif()
 
+    set(walker_cpp "//")
+
+    if(arg_WALKER)
+        unset(walker_cpp)
+    endif()
+
     set(antlr antlr4)
 
     # check if both .g4 are present
@@ -129,7 +135,12 @@ function(project_antlr_library namespace lib grammar jar)
     set_target_properties(${namespace}.${lib} PROPERTIES ANTLR_LIBRARY TRUE)
     target_include_directories(${namespace}.${lib} SYSTEM PUBLIC "${dir_cpp}/")
     target_include_directories(${namespace}.${lib} SYSTEM PUBLIC "${CMAKE_CURRENT_LIST_DIR}/Libs/antlr/runtime/Cpp/runtime/src/")
-    target_compile_definitions(${namespace}.${lib} PUBLIC "ANTLR4_USE_THREAD_LOCAL_CACHE=1")
+    # by default, each thread builds its own DFA; with SHARED_CACHE all threads extends same DFA, guarded by runtime locks
+    if(arg_SHARED_CACHE)
+        target_compile_definitions(${namespace}.${lib} PUBLIC "ANTLR4_USE_THREAD_LOCAL_CACHE=0")
+    else()
+        target_compile_definitions(${namespace}.${lib} PUBLIC "ANTLR4_USE_THREAD_LOCAL_CACHE=1")
+    endif()
     target_link_libraries(${namespace}.${lib} PUBLIC antlr4_static)
     get_property(sources_cpp TARGET ${namespace}.${lib} PROPERTY SOURCES)
 
@@ -141,6 +152,15 @@ function(project_antlr_library namespace lib grammar jar)
     list( APPEND command_line_java -Dlanguage=Java )
     #list( APPEND command_line_java -package ${namespace}.${lib} )
 
+    # generated sources are patched in same step, so they're never built unpatched
+    if(arg_NO_VERIFY)
+        set(startup_script "${CMAKE_CURRENT_FUNCTION_LIST_DIR}/ANTLR.startup.cmake")
+        set(post_cpp
+            COMMAND "${CMAKE_COMMAND}" -Dinput=${dir_cpp}/${lexer}.cpp -P "${startup_script}"
+            COMMAND "${CMAKE_COMMAND}" -Dinput=${dir_cpp}/${parser}.cpp -P "${startup_script}"
+        )
+    endif()
+
     foreach( tmp IN ITEMS cpp java )
         list( PREPEND command_line_${tmp} -Werror )
         list( PREPEND command_line_${tmp} -jar "\"${jar_path}\"" )
@@ -154,10 +174,27 @@ function(project_antlr_library namespace lib grammar jar)
             OUTPUT      ${sources_${tmp}}
             BYPRODUCTS  "${dir_${tmp}}/${lexer}.interp" "${dir_${tmp}}/${lexer}.tokens" "${dir_${tmp}}/${parser}.interp" "${dir_${tmp}}/${parser}.tokens"
             COMMAND     "${Java_JAVA_EXECUTABLE}" ${command_line_${tmp}}
-            DEPENDS     "${jar}" "${g4lexer}" "${g4parser}"
+            ${post_${tmp}}
+            DEPENDS     "${jar}" "${g4lexer}" "${g4parser}" ${startup_script}
         )
     endforeach()
 
+    # statically dispatched walker, created from rules list found in generated parser
+
+    if(arg_WALKER)
+        set(walker_script   "${CMAKE_CURRENT_FUNCTION_LIST_DIR}/ANTLR.walker.cmake")
+        set(walker_template "${CMAKE_CURRENT_FUNCTION_LIST_DIR}/ANTLR.walker.hpp.in")
+        set(walker_header   "${dir_cpp}/${namespace}.${lib}.walker.hpp")
+
+        add_custom_command(
+            OUTPUT   "${walker_header}"
+            COMMAND  "${CMAKE_COMMAND}" -DPROJECT_NAME=${PROJECT_NAME} -DPROJECT_VERSION=${PROJECT_VERSION} -Dnamespace=${namespace} -Dparser=${parser} -Dinput=${dir_cpp}/${parser}.h -Dtemplate=${walker_template} -Doutput=${walker_header} -P "${walker_script}"
+            DEPENDS  "${dir_cpp}/${parser}.h" "${walker_script}" "${walker_template}"
+            VERBATIM
+        )
+        target_sources(${namespace}.${lib} PRIVATE "${walker_header}")
+    endif()
+
     if(NOT Java_JAVAC_EXECUTABLE)
         return()
     endif()
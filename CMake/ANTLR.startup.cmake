@@ -0,0 +1,24 @@
+cmake_minimum_required(VERSION 3.18.4 FATAL_ERROR)
+
+#
+# disables ATN verification in generated lexer or parser
+# ATN is verified by antlr tool when sources are generated, repeating it during static data initialization only delays first parsing
+# cmake -Dinput=<lexer/parser.cpp> -P ANTLR.startup.cmake
+#
+
+if(NOT DEFINED input)
+    message(FATAL_ERROR "Missing variable: input")
+endif()
+
+file(READ "${input}" content)
+
+set(find "antlr4::atn::ATNDeserializer deserializer;")
+set(replace "antlr4::atn::ATNDeserializationOptions deserializerOptions;\n  deserializerOptions.setVerifyATN(false);\n  antlr4::atn::ATNDeserializer deserializer(deserializerOptions);")
+
+string(FIND "${content}" "${find}" found)
+if(found EQUAL -1)
+    message(FATAL_ERROR "ATN deserializer not found: ${input}")
+endif()
+
+string(REPLACE "${find}" "${replace}" content "${content}")
+file(WRITE "${input}" "${content}")
@@ -0,0 +1,47 @@
+cmake_minimum_required(VERSION 3.18.4 FATAL_ERROR)
+
+#
+# creates statically dispatched walker from rules list found in generated parser header
+# cmake -DPROJECT_NAME=... -DPROJECT_VERSION=... -Dnamespace=... -Dparser=... -Dinput=<parser.h> -Dtemplate=<walker.hpp.in> -Doutput=<walker.hpp> -P ANTLR.walker.cmake
+#
+
+foreach(var IN ITEMS namespace parser input template output)
+    if(NOT DEFINED ${var})
+        message(FATAL_ERROR "Missing variable: ${var}")
+    endif()
+endforeach()
+
+file(READ "${input}" content)
+
+# enum {
+#   RuleFoo = 0, RuleBar = 1, ...
+# };
+string(REGEX MATCHALL "Rule[A-Za-z0-9_]+ = [0-9]+" rules "${content}")
+if(NOT rules)
+    message(FATAL_ERROR "Rules not found: ${input}")
+endif()
+
+set(walker_handlers "")
+set(walker_enter    "")
+set(walker_exit     "")
+
+foreach(rule IN LISTS rules)
+    string(REGEX REPLACE "^Rule([A-Za-z0-9_]+) = [0-9]+$" "\\1" name "${rule}")
+
+    string(APPEND walker_handlers "        void Enter${name}( ${parser}::${name}Context* ) {}\n")
+    string(APPEND walker_handlers "        void Exit${name}( ${parser}::${name}Context* ) {}\n")
+
+    foreach(type IN ITEMS enter exit)
+        if(type STREQUAL "enter")
+            set(function "Enter${name}")
+        else()
+            set(function "Exit${name}")
+        endif()
+
+        string(APPEND walker_${type} "                case ${parser}::Rule${name}:\n")
+        string(APPEND walker_${type} "                    Self().${function}( static_cast<${parser}::${name}Context*>( context ) );\n")
+        string(APPEND walker_${type} "                    break;\n")
+    endforeach()
+endforeach()
+
+configure_file("${template}" "${output}" @ONLY NEWLINE_STYLE UNIX)
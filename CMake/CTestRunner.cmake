@@ -10,7 +10,7 @@ include_guard()
 #   my-program/          <- name of the target
 #     my-test.txt        <- test file
 #     my-test.WILL_FAIL  <- (optional) one of test configuration files
-#   CMakeLists.txt       <- ctest_runner( my-program "-f @filename@" "txt" )
+#   CMakeLists.txt       <- ctest_runner( my-program "-f @filename@" "txt" [ADD_GLOB <glob>...] [EXCLUDE_GLOB <glob>...] [BUDGET <command_line>] [BUDGET_FIXTURE <fixture>] )
 #
 ## Command line modification
 #
@@ -31,6 +31,28 @@ include_guard()
 #   see https://cmake.org/cmake/help/v3.18/prop_test/DISABLED.html
 # <test_file>.WILL_FAIL
 #   see https://cmake.org/cmake/help/v3.18/prop_test/WILL_FAIL.html
+# <test_file>.TIMEOUT
+#   file must contain number of seconds
+#   see https://cmake.org/cmake/help/v3.18/prop_test/TIMEOUT.html
+#
+# <test_file>.PASS_REGULAR_EXPRESSION
+#   each non-empty line is used as separate regular expression, test passes if output matches any of them
+#   note that process exit code is ignored by ctest when this property is set
+#   see https://cmake.org/cmake/help/v3.18/prop_test/PASS_REGULAR_EXPRESSION.html
+# <test_file>.FAIL_REGULAR_EXPRESSION
+#   each non-empty line is used as separate regular expression, test fails if output matches any of them
+#   see https://cmake.org/cmake/help/v3.18/prop_test/FAIL_REGULAR_EXPRESSION.html
+#
+## Performance budgets
+#
+# .BUDGET
+# <test_file>.BUDGET
+#   if both files are present, only <test_file>.BUDGET is used
+#   file content is not read, it's passed to executable using command line set with BUDGET argument,
+#   where @budget@ is replaced with budget file path; files are ignored if BUDGET argument is not set
+#   if BUDGET_FIXTURE argument is set, test requires given fixture (calibration run, etc.)
+#   files are ignored for tests with <test_file>.WILL_FAIL, as budget violation would be counted as expected failure
+#   see https://cmake.org/cmake/help/v3.18/prop_test/FIXTURES_REQUIRED.html
 #
 ## Custom groups
 #
@@ -99,12 +121,14 @@ function( ${CTestRunner.FunctionName} target command_line extension ... )
         return()
     endif()
 
-    cmake_parse_arguments( PARSE_ARGV 3 arg "" "" "ADD_GLOB" )
+    cmake_parse_arguments( PARSE_ARGV 3 arg "" "BUDGET;BUDGET_FIXTURE" "ADD_GLOB;EXCLUDE_GLOB" )
 
     # test configuration files extensions
-    set( test_config_edit COMMAND_LINE COMMAND_LINE_BEFORE COMMAND_LINE_AFTER GROUP )
+    set( test_config_edit COMMAND_LINE COMMAND_LINE_BEFORE COMMAND_LINE_AFTER GROUP BUDGET )
     set( test_config_copy DISABLED WILL_FAIL )
-    set( test_config_dir  GROUP )
+    set( test_config_read TIMEOUT )
+    set( test_config_list PASS_REGULAR_EXPRESSION FAIL_REGULAR_EXPRESSION )
+    set( test_config_dir  GROUP BUDGET )
 
     # search for test files
     list( PREPEND arg_ADD_GLOB "${target}/*.${extension}" )
@@ -119,7 +143,7 @@ function( ${CTestRunner.FunctionName} target command_line extension ... )
         # search for test configuration files
         # while not used directly, they're added to autogenerated VerifyGlobs.cmake
         get_filename_component( find_glob "${find_glob}" DIRECTORY )
-        foreach( tmp IN LISTS test_config_edit test_config_copy )
+        foreach( tmp IN LISTS test_config_edit test_config_copy test_config_read test_config_list )
             cmake_language( CALL ${this}.debug "TEST" "- Find test config... ${find_glob}/*.${tmp}" )
 
             file( GLOB_RECURSE tmp LIST_DIRECTORIES false FOLLOW_SYMLINKS RELATIVE "${CMAKE_CURRENT_LIST_DIR}" CONFIGURE_DEPENDS "${find_glob}/*.${tmp}" )
@@ -132,6 +156,17 @@ function( ${CTestRunner.FunctionName} target command_line extension ... )
             unset( tmp )
         endforeach()
     endforeach()
+
+    # remove test files matching any of excluded globs
+    foreach( find_glob IN LISTS arg_EXCLUDE_GLOB )
+        cmake_language( CALL ${this}.debug "TEST" "Exclude test files... ${find_glob}" )
+
+        file( GLOB_RECURSE found_tmp LIST_DIRECTORIES false FOLLOW_SYMLINKS RELATIVE "${CMAKE_CURRENT_LIST_DIR}" CONFIGURE_DEPENDS "${find_glob}" )
+        if( found_tmp AND found_tests )
+            list( REMOVE_ITEM found_tests ${found_tmp} )
+        endif()
+    endforeach()
+
     list( REMOVE_DUPLICATES found_tests )
     list( SORT found_tests )
 
@@ -195,6 +230,34 @@ function( ${CTestRunner.FunctionName} target command_line extension ... )
         endforeach()
         string( STRIP "${test_command_line_before} ${test_command_line} ${test_command_line_after}" test_command_line_full )
 
+        # test config : budget
+        # added at the end of command line, regardless of other command line files
+        unset( test_budget_file )
+        if( arg_BUDGET )
+            foreach( file IN ITEMS "${test_path_dir}/.BUDGET" "${test_path_noext}.BUDGET" )
+                if( EXISTS "${file}" )
+                    set( test_budget_file "${file}" )
+                endif()
+            endforeach()
+        endif()
+
+        if( test_budget_file AND EXISTS "${test_path_noext}.WILL_FAIL" )
+            if( "${test_budget_file}" STREQUAL "${test_path_noext}.BUDGET" )
+                message( AUTHOR_WARNING "Test budget cannot be used with WILL_FAIL, ignored\nfile = ${test_budget_file}" )
+            endif()
+
+            cmake_language( CALL ${this}.debug "TEST" "- budget            ignored, test must fail" )
+            unset( test_budget_file )
+        endif()
+
+        if( test_budget_file )
+            string( REPLACE "@budget@" "${test_budget_file}" tmp "${arg_BUDGET}" )
+            string( APPEND test_command_line_full " ${tmp}" )
+
+            list( APPEND test_used_files "${test_budget_file}" )
+            cmake_language( CALL ${this}.debug "TEST" "- budget            ${test_budget_file}" )
+        endif()
+
         if( test_used_files.command-line )
             cmake_language( CALL ${this}.debug "TEST" "- command line      ${test_command_line_full}" )
         endif()
@@ -218,6 +281,10 @@ function( ${CTestRunner.FunctionName} target command_line extension ... )
         add_test( NAME "${test_name}" COMMAND  "$<TARGET_FILE:${target}>" ${test_command_line_full} )
         cmake_language( CALL ${this}.label "${test_name}" ":${target}" )
 
+        if( test_budget_file AND arg_BUDGET_FIXTURE )
+            set_property( TEST "${test_name}" APPEND PROPERTY FIXTURES_REQUIRED "${arg_BUDGET_FIXTURE}" )
+        endif()
+
         # test config : cmake properties : DISABLED WILL_FAIL
         foreach( property IN LISTS test_config_copy )
             if( EXISTS "${test_path_noext}.${property}" )
@@ -236,6 +303,38 @@ function( ${CTestRunner.FunctionName} target command_line extension ... )
             continue()
         endif()
 
+        # test config : cmake properties : TIMEOUT
+        foreach( property IN LISTS test_config_read )
+            if( EXISTS "${test_path_noext}.${property}" )
+                file( READ "${test_path_noext}.${property}" tmp )
+                string( STRIP "${tmp}" tmp )
+                if( tmp MATCHES "^[0-9]+(\\.[0-9]+)?$" )
+                    cmake_language( CALL ${this}.debug "TEST" "- property          ${property} = ${tmp}" )
+                    set_property( TEST "${test_name}" PROPERTY ${property} ${tmp} )
+
+                    list( APPEND test_used_files "${test_path_noext}.${property}" )
+                else()
+                    message( AUTHOR_WARNING "Invalid test ${property} value, ignored\nvalue = \"${tmp}\"\nfile = ${test_path_noext}.${property}" )
+                endif()
+            endif()
+        endforeach( property )
+
+        # test config : cmake properties : PASS_REGULAR_EXPRESSION FAIL_REGULAR_EXPRESSION
+        foreach( property IN LISTS test_config_list )
+            if( EXISTS "${test_path_noext}.${property}" )
+                file( STRINGS "${test_path_noext}.${property}" tmp )
+                list( FILTER tmp EXCLUDE REGEX "^$" )
+                if( tmp )
+                    cmake_language( CALL ${this}.debug "TEST" "- property          ${property} = ${tmp}" )
+                    set_property( TEST "${test_name}" PROPERTY ${property} "${tmp}" )
+
+                    list( APPEND test_used_files "${test_path_noext}.${property}" )
+                else()
+                    message( AUTHOR_WARNING "Empty test ${property} file, ignored\nfile = ${test_path_noext}.${property}" )
+                endif()
+            endif()
+        endforeach( property )
+
         # test config : cmake properties : LABELS
         # user-defined labels, known as groups, are more strict than what cmake itself allows
         # only one group can be set per test, and they have to follow naming scheme used by other labels
@@ -302,6 +401,17 @@ function( ${CTestRunner.FunctionName} target command_line extension ... )
             )
         endif()
 
+        if( test_budget_file )
+            cmake_language( CALL ${this}.label "${test_name}" "budget" )
+            cmake_language( CALL ${this}.target only.budget
+                CTEST --label-regex ^${this}:budget$
+                HELP_TEXT "Run enabled tests with performance budget"
+                HELP_LIST "USER"
+                ADD_ONCE
+                ADD_DEPENDENCY ${target}
+            )
+        endif()
+
         cmake_language( CALL ${this}.label "${test_name}" "extension:${test_file_ext}" )
         cmake_language( CALL ${this}.target only.extension.${test_file_ext}
             CTEST --label-regex ^${this}:extension:${test_file_ext}$
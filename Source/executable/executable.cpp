@@ -1,19 +1,170 @@
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <chrono>
 #include <cstdio>  // setvbuf
 #include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <utility>
 
 #include "executable.hpp"
+#include "prs.archive.hpp"
+#include "prs.counters.hpp"
+#include "prs.json.hpp"
+#include "prs.memory.hpp"
+#include "prs.tree.hpp"
 
 using namespace std::string_literals;
 
 namespace
 {
-    const std::string OptionHelp = "help";
-    const std::string OptionFile = "file";
+    const std::string OptionHelp  = "help";
+    const std::string OptionFile  = "file";
+    const std::string OptionBatch = "batch";
+
+    const std::string OptionTimeout    = "timeout";
+    const std::string OptionErrorLimit = "error-limit";
+    const std::string OptionDepthLimit = "depth-limit";
+
+    const std::string OptionBudget      = "budget";
+    const std::string OptionCalibrate   = "calibrate";
+    const std::string OptionCalibration = "calibration";
 
     const std::string OptionTokens = "tokens";
     const std::string OptionTrace  = "trace";
     const std::string OptionTree   = "tree";
 
+    const std::string OptionProfile  = "profile";
+    const std::string OptionMemstats = "memstats";
+    const std::string OptionStartup  = "startup";
+
+    const std::string OptionTraceEvents = "trace-events";
+    const std::string OptionCounters    = "counters";
+
+    // --profile columns, in output order
+    const std::vector<std::pair<std::string, std::function<long long( const prs::decision_profile& )>>> ProfileColumns = {
+        { "decision", []( const prs::decision_profile& profile ) { return static_cast<long long>( profile.Decision ); } },
+        { "invocations", []( const prs::decision_profile& profile ) { return profile.Invocations; } },
+        { "time", []( const prs::decision_profile& profile ) { return profile.Time; } },
+        { "sll-look", []( const prs::decision_profile& profile ) { return profile.SLL_TotalLook; } },
+        { "sll-max", []( const prs::decision_profile& profile ) { return profile.SLL_MaxLook; } },
+        { "ll-look", []( const prs::decision_profile& profile ) { return profile.LL_TotalLook; } },
+        { "ll-max", []( const prs::decision_profile& profile ) { return profile.LL_MaxLook; } },
+        { "ll-fallback", []( const prs::decision_profile& profile ) { return profile.LL_Fallback; } },
+        { "ambiguities", []( const prs::decision_profile& profile ) { return static_cast<long long>( profile.Ambiguities ); } },
+        { "context-sensitivities", []( const prs::decision_profile& profile ) { return static_cast<long long>( profile.ContextSensitivities ); } },
+        { "errors", []( const prs::decision_profile& profile ) { return static_cast<long long>( profile.Errors ); } } };
+
+    // --memstats, units counted by each phase: characters, tokens, tree nodes, nothing
+    struct memstats_phase
+    {
+        size_t Allocations = 0;
+        size_t Bytes       = 0;
+        size_t PeakRSS     = 0;
+        size_t Units       = 0;
+    };
+
+    struct memstats_file
+    {
+        std::string                   Filename = {};
+        std::array<memstats_phase, 4> Phases   = {};
+
+        size_t Bytes() const
+        {
+            size_t result = 0;
+            for( const auto& stats : Phases )
+                result += stats.Bytes;
+
+            return result;
+        }
+    };
+
+    const std::array<std::string, 4> MemstatsPhases = { "load", "lexing", "parsing", "output" };
+
+    std::vector<memstats_file> Memstats;
+    prs::memory::stats         MemstatsStart;
+
+    // --budget, time spent on lexing and parsing in RunParserWithOptions(), without diagnostics output
+    double BudgetSeconds = 0;
+
+    // --calibrate, number of measured runs; first run is not measured
+    constexpr size_t CalibrationRuns = 5;
+
+    // --startup, stages are recorded even if option is not used, as they're usually marked before options are parsed
+    std::vector<std::pair<std::string, double>> Startup;
+    prs::deadline::clock::time_point            StartupLast;
+
+    // --trace-events, each thread records into its own buffer; buffers are owned globally, so they outlive threads
+    struct trace_event
+    {
+        const char*                      Name  = nullptr;
+        bool                             Begin = false;
+        prs::deadline::clock::time_point Time  = {};
+        std::string                      File  = {};  // load phase end only
+    };
+
+    struct trace_thread
+    {
+        size_t                   Id     = 0;
+        std::vector<trace_event> Events = {};
+    };
+
+    // parsing phase is named after prediction mode, see DiagnosticsTraceEvents()
+    const std::array<const char*, 4> TraceEventsPhases = { "load", "lexing", "parsing (LL)", "output" };
+
+    std::mutex                                 TraceEventsLock;
+    std::vector<std::unique_ptr<trace_thread>> TraceEventsThreads;
+
+    // lock is taken only once per thread, when its buffer is created
+    trace_thread& TraceEventsThread()
+    {
+        thread_local trace_thread* current = nullptr;
+
+        if( !current )
+        {
+            std::lock_guard<std::mutex> lock( TraceEventsLock );
+
+            TraceEventsThreads.push_back( std::make_unique<trace_thread>() );
+            current     = TraceEventsThreads.back().get();
+            current->Id = TraceEventsThreads.size();
+            current->Events.reserve( 1024 );
+        }
+
+        return *current;
+    }
+
+    // --counters, parsing phase is split by prediction mode
+    const std::array<std::string, 5> CountersPhases = { "load", "lexing", "parsing (SLL)", "parsing (LL)", "output" };
+
+    std::unique_ptr<prs::counters::group> Counters;
+    std::array<prs::counters::values, 5>  CountersStart;
+    std::array<prs::counters::values, 5>  CountersTotal;
+    size_t                                CountersChars      = 0;
+    size_t                                CountersTokens     = 0;
+    size_t                                CountersFileTokens = 0;  // highest number of tokens seen for current file, lexing is done lazily
+
+    size_t CountersPhase( prs::base& base, prs::phase step )
+    {
+        switch( step )
+        {
+            case prs::phase::Load:
+                return 0;
+            case prs::phase::Lexing:
+                return 1;
+            case prs::phase::Parsing:
+                return base.GetParser()->getInterpreter<antlr4::atn::ParserATNSimulator>()->getPredictionMode() == antlr4::atn::PredictionMode::SLL ? 2 : 3;
+            case prs::phase::Output:
+                return 4;
+        }
+
+        return 0;
+    }
+
     cxxopts::Options     Options( "prs" );
     cxxopts::ParseResult OptionsParsed;
     bool                 OptionsParsedAlready = false;
@@ -52,20 +203,112 @@ namespace
         std::exit( status );
     }
 
+    size_t CountNodes( antlr4::tree::ParseTree* tree )
+    {
+        size_t                                result = 0;
+        std::vector<antlr4::tree::ParseTree*> stack;
+
+        if( tree )
+            stack.push_back( tree );
+
+        while( !stack.empty() )
+        {
+            antlr4::tree::ParseTree* node = stack.back();
+            stack.pop_back();
+
+            result++;
+            stack.insert( stack.end(), node->children.begin(), node->children.end() );
+        }
+
+        return result;
+    }
+
+    double Seconds( prs::deadline::clock::time_point start )
+    {
+        return std::chrono::duration<double>( prs::deadline::clock::now() - start ).count();
+    }
+
     void RunParserBefore( prs::base& base )
     {
+        if( prs::executable::options::IsErrorLimit() )
+            base.CollectErrors( prs::executable::options::ErrorLimit() );
+
+        if( prs::executable::options::IsDepthLimit() )
+            base.SetDepthLimit( prs::executable::options::DepthLimit() );
+
         prs::executable::options::DiagnosticsTrace( base );
+        prs::executable::options::DiagnosticsProfile( base );
+
+        // keep lexing separated from other phases; lexing counts against --budget, writing tokens does not
+        if( prs::executable::options::IsMemstats() || prs::executable::options::IsBudget() )
+        {
+            auto start = prs::deadline::clock::now();
+            base.FillTokens();
+            BudgetSeconds += Seconds( start );
+        }
+
+        base.RunProbe( prs::phase::Output, true );
         prs::executable::options::DiagnosticsTokens( base );
+        base.RunProbe( prs::phase::Output, false );
+    }
+
+    // reads `key = value` lines, empty lines and lines starting with '#' are ignored
+    bool ReadValues( const std::string& filename, std::vector<std::pair<std::string, double>>& values )
+    {
+        std::string content;
+        if( !prs::LoadFile( filename, content ) )
+            return false;
+
+        std::istringstream stream( content );
+        std::string        line;
+        while( std::getline( stream, line ) )
+        {
+            line.erase( 0, line.find_first_not_of( " \t\r" ) );
+            if( line.empty() || line.front() == '#' )
+                continue;
+
+            size_t separator = line.find( '=' );
+            if( separator == std::string::npos )
+                return false;
+
+            std::string key = line.substr( 0, separator );
+            key.erase( key.find_last_not_of( " \t" ) + 1 );
+
+            std::istringstream valueStream( line.substr( separator + 1 ) );
+            double             value = 0;
+            if( !( valueStream >> value ) || value < 0 )
+                return false;
+
+            values.emplace_back( key, value );
+        }
+
+        return true;
     }
 
     void RunParserAfter( prs::base& base )
     {
+        if( prs::executable::options::IsErrorLimit() )
+        {
+            for( const auto& error : base.GetErrors() )
+                std::cerr << "line " << error.Line << ":" << error.Column << " " << error.Message << std::endl;
+
+            if( base.IsErrorLimitReached() )
+                prs::executable::Error( "Error limit reached, parsing aborted <" + base.GetInput()->GetName() + ">" );
+        }
+
+        if( base.IsDepthLimitReached() )
+            prs::executable::Error( "Nesting limit reached, parsing aborted <" + base.GetInput()->GetName() + ">" );
+
+        base.RunProbe( prs::phase::Output, true );
         prs::executable::options::DiagnosticsTree( base );
+        base.RunProbe( prs::phase::Output, false );
     }
 }  // namespace
 
 void prs::executable::Init( int argc, char** argv, const std::string& program )
 {
+    StartupLast = prs::deadline::clock::now();
+
     std::setvbuf( stdout, nullptr, _IONBF, 0 );
 
     ArgC = argc;
@@ -117,8 +360,12 @@ void prs::executable::Error( const std::string& message )
 
 bool prs::executable::RunParserWithOptions( prs::base& base )
 {
+    std::unique_ptr<prs::deadline> until = options::Deadline();
+
     RunParserBefore( base );
-    bool result = base.ParseAdaptive();
+    auto start  = prs::deadline::clock::now();
+    bool result = base.ParseAdaptive( until.get() );
+    BudgetSeconds += Seconds( start );
     RunParserAfter( base );
 
     return result;
@@ -127,7 +374,9 @@ bool prs::executable::RunParserWithOptions( prs::base& base )
 bool prs::executable::RunParserWithOptions( prs::base& base, antlr4::atn::PredictionMode mode )
 {
     RunParserBefore( base );
+    auto start  = prs::deadline::clock::now();
     bool result = base.Parse( mode );
+    BudgetSeconds += Seconds( start );
     RunParserAfter( base );
 
     return result;
@@ -159,7 +408,7 @@ cxxopts::ParseResult& prs::executable::options::GetParsed()
 
 void prs::executable::options::AddFile()
 {
-    Get().add_options()( OptionFile, "File", cxxopts::value<std::string>()->implicit_value( "" ) );
+    Get().add_options()( OptionFile, "File (- = standard input)", cxxopts::value<std::string>()->implicit_value( "" ) );
 }
 
 std::string prs::executable::options::File()
@@ -176,12 +425,255 @@ std::string prs::executable::options::File()
     else
         ExitError( EXIT_FAILURE, "[Options] Missing option <" + OptionFile + ">", Get().help() );
 
-    if( !std::filesystem::exists( result ) )
+    if( result != "-" && !std::filesystem::exists( result ) )
         ExitError( EXIT_FAILURE, "[Options] File does not exist <" + result + ">", Get().help() );
 
     return result;
 }
 
+void prs::executable::options::AddTimeout()
+{
+    Get().add_options()( OptionTimeout, "Parsing time limit per file (seconds)", cxxopts::value<double>() );
+}
+
+double prs::executable::options::Timeout()
+{
+    if( !GetParsed().count( OptionTimeout ) )
+        return 0;
+
+    double result = GetParsed()[OptionTimeout].as<double>();
+    if( result <= 0 )
+        ExitError( EXIT_FAILURE, "[Options] Invalid argument for option <" + OptionTimeout + ">", Get().help() );
+
+    return result;
+}
+
+std::unique_ptr<prs::deadline> prs::executable::options::Deadline()
+{
+    double timeout = Timeout();
+    if( timeout <= 0 )
+        return nullptr;
+
+    return std::make_unique<prs::deadline>( std::chrono::duration_cast<prs::deadline::clock::duration>( std::chrono::duration<double>( timeout ) ) );
+}
+
+void prs::executable::options::AddBudget()
+{
+    auto option = Get().add_options( "Budget" );
+    option( OptionBudget, "Fail if parsing time or peak memory exceeds limits from given file", cxxopts::value<std::string>() );
+    option( OptionCalibration, "Calibration file, used to convert time budget to seconds", cxxopts::value<std::string>() );
+    option( OptionCalibrate, "Measure parsing time of file and write it to given calibration file", cxxopts::value<std::string>() );
+}
+
+bool prs::executable::options::IsBudget()
+{
+    return GetParsed().count( OptionBudget ) > 0;
+}
+
+bool prs::executable::options::IsCalibrate()
+{
+    return GetParsed().count( OptionCalibrate ) > 0;
+}
+
+// single parsing run is too noisy to be used as unit, median of several runs with warm DFA is used instead
+bool prs::executable::options::Calibrate( prs::base& base )
+{
+    std::string filename = File();
+    std::string content;
+    if( !prs::LoadFile( filename, content ) )
+    {
+        prs::executable::Error( "File cannot be loaded <" + filename + ">" );
+        return false;
+    }
+
+    std::vector<double> runs;
+    bool                result = true;
+    for( size_t run = 0; result && run <= CalibrationRuns; run++ )
+    {
+        base.LoadBuffer( content, filename );
+
+        auto start = prs::deadline::clock::now();
+        result     = base.ParseAdaptive();
+
+        // first run fills DFA cache, it's not measured
+        if( run > 0 )
+            runs.push_back( Seconds( start ) );
+    }
+
+    base.UnloadFile();
+
+    if( !result )
+    {
+        prs::executable::Error( "Calibration file cannot be parsed <" + filename + ">" );
+        return false;
+    }
+
+    auto median = runs.begin() + runs.size() / 2;
+    std::nth_element( runs.begin(), median, runs.end() );
+    double units = *median;
+
+    std::string   calibration = GetParsed()[OptionCalibrate].as<std::string>();
+    std::ofstream stream( calibration, std::ios_base::out | std::ios_base::trunc );
+    if( !( stream << "# median parsing time of " << filename << ", " << CalibrationRuns << " runs" << '\n' << "unit = " << std::to_string( units ) << '\n' ) )
+    {
+        prs::executable::Error( "Calibration file cannot be written <" + calibration + ">" );
+        return false;
+    }
+
+    prs::executable::Notice( "Calibration unit = " + std::to_string( units ) + "s" );
+    return true;
+}
+
+bool prs::executable::options::BudgetResult()
+{
+    if( !IsBudget() )
+        return true;
+
+    std::string                                 filename = GetParsed()[OptionBudget].as<std::string>();
+    std::vector<std::pair<std::string, double>> budget;
+    if( !ReadValues( filename, budget ) )
+        ExitError( EXIT_FAILURE, "[Options] Invalid budget file <" + filename + ">" );
+
+    bool result = true;
+    for( const auto& [key, limit] : budget )
+    {
+        if( key == "time" )
+        {
+            if( !GetParsed().count( OptionCalibration ) )
+            {
+                prs::executable::Warning( "Time budget ignored, missing option <" + OptionCalibration + ">" );
+                continue;
+            }
+
+            // trace is written while parsing, it cannot be measured separately
+            if( IsTrace() )
+            {
+                prs::executable::Warning( "Time budget ignored, option <" + OptionTrace + "> writes output while parsing" );
+                continue;
+            }
+
+            std::string                                 calibration = GetParsed()[OptionCalibration].as<std::string>();
+            std::vector<std::pair<std::string, double>> values;
+            if( !ReadValues( calibration, values ) || values.size() != 1 || values.front().first != "unit" || values.front().second <= 0 )
+                ExitError( EXIT_FAILURE, "[Options] Invalid calibration file <" + calibration + ">" );
+
+            double units = BudgetSeconds / values.front().second;
+            if( units > limit )
+            {
+                prs::executable::Error( "Parsing time budget exceeded <measured " + std::to_string( units ) + " units (" + std::to_string( BudgetSeconds ) + "s), allowed " + std::to_string( limit ) + " units (" + std::to_string( limit * values.front().second ) + "s)>" );
+                result = false;
+            }
+        }
+        else if( key == "memory" )
+        {
+            size_t peak = prs::memory::PeakRSS();
+            if( !peak )
+            {
+                prs::executable::Warning( "Memory budget ignored, peak RSS is not available on this platform" );
+                continue;
+            }
+
+            double mebibytes = static_cast<double>( peak ) / ( 1024 * 1024 );
+            if( mebibytes > limit )
+            {
+                prs::executable::Error( "Peak memory budget exceeded <measured " + std::to_string( mebibytes ) + " MiB, allowed " + std::to_string( limit ) + " MiB>" );
+                result = false;
+            }
+        }
+        else
+            ExitError( EXIT_FAILURE, "[Options] Unknown budget <" + key + "> in file <" + filename + ">" );
+    }
+
+    return result;
+}
+
+void prs::executable::options::AddErrorLimit()
+{
+    Get().add_options()( OptionErrorLimit, "Abort parsing after given number of errors (0 = no limit)", cxxopts::value<size_t>()->implicit_value( "1" ) );
+}
+
+bool prs::executable::options::IsErrorLimit()
+{
+    return GetParsed().count( OptionErrorLimit ) > 0;
+}
+
+size_t prs::executable::options::ErrorLimit()
+{
+    return IsErrorLimit() ? GetParsed()[OptionErrorLimit].as<size_t>() : 0;
+}
+
+void prs::executable::options::AddDepthLimit()
+{
+    Get().add_options()( OptionDepthLimit, "Abort parsing when rules are nested deeper than given level (0 = no limit)", cxxopts::value<size_t>()->implicit_value( "2000" ) );
+}
+
+bool prs::executable::options::IsDepthLimit()
+{
+    return GetParsed().count( OptionDepthLimit ) > 0;
+}
+
+size_t prs::executable::options::DepthLimit()
+{
+    return IsDepthLimit() ? GetParsed()[OptionDepthLimit].as<size_t>() : 0;
+}
+
+void prs::executable::options::AddBatch()
+{
+    Get().add_options()( OptionBatch, "Batch (directory, .dat archive or list of files)", cxxopts::value<std::string>() );
+}
+
+std::vector<std::string> prs::executable::options::Files( const std::string& extension )
+{
+    if( !GetParsed().count( OptionBatch ) )
+        return { File() };
+
+    std::vector<std::string> result;
+    std::string              batch = GetParsed()[OptionBatch].as<std::string>();
+
+    if( std::filesystem::is_directory( batch ) )
+    {
+        for( const auto& entry : std::filesystem::recursive_directory_iterator( batch ) )
+        {
+            if( entry.is_regular_file() && entry.path().extension() == "." + extension )
+                result.push_back( entry.path().string() );
+        }
+
+        std::sort( result.begin(), result.end() );
+    }
+    else if( prs::archive::IsArchive( batch ) && std::filesystem::is_regular_file( batch ) )
+    {
+        std::shared_ptr<const prs::archive::archive> archive = prs::archive::Get( batch );
+        if( !archive )
+            ExitError( EXIT_FAILURE, "[Options] Batch is not a valid archive <" + batch + ">", Get().help() );
+
+        for( const auto& entry : archive->GetEntries() )
+        {
+            if( prs::archive::IsExtension( entry.Name, extension ) )
+                result.push_back( batch + "/" + entry.Name );
+        }
+
+        std::sort( result.begin(), result.end() );
+    }
+    else if( std::filesystem::is_regular_file( batch ) )
+    {
+        std::ifstream stream( batch );
+        std::string   line;
+
+        while( std::getline( stream, line ) )
+        {
+            if( !line.empty() && line.back() == '\r' )
+                line.pop_back();
+
+            if( !line.empty() )
+                result.push_back( line );
+        }
+    }
+    else
+        ExitError( EXIT_FAILURE, "[Options] Batch does not exist <" + batch + ">", Get().help() );
+
+    return result;
+}
+
 //
 
 void prs::executable::options::AddGroupDiagnostics()
@@ -190,19 +682,24 @@ void prs::executable::options::AddGroupDiagnostics()
     option( OptionTokens, "Tokens", cxxopts::value<std::string>()->implicit_value( "" ) );
     option( OptionTrace, "Trace" );
     option( OptionTree, "Tree" );
+    option( OptionMemstats, "Memory usage of each phase, for given number of files with most bytes allocated", cxxopts::value<size_t>()->implicit_value( "10" ) );
+    option( OptionStartup, "Time spent in each startup stage" );
+    option( OptionCounters, "Hardware performance counters of each phase (Linux only)" );
+    option( OptionTraceEvents, "Write timeline of each phase, per thread, to given file (Chrome trace event format)", cxxopts::value<std::string>() );
+    option( OptionProfile, "Profile prediction decisions, sorted by column (rule, decision, invocations, time, sll-look, sll-max, ll-look, ll-max, ll-fallback, ambiguities, context-sensitivities, errors)", cxxopts::value<std::string>()->implicit_value( "time" ) );
 }
 
 void prs::executable::options::DiagnosticsTokens( prs::base& base )  // Diagnostics() call
 {
-    if( !GetParsed().count( OptionTokens ) )
+    if( !IsTokens() )
         return;
 
-    base.PrintTokens( OptionsParsed[OptionTokens].as<std::string>() == "full" );
+    base.PrintTokens( IsTokensFull() );
 }
 
 void prs::executable::options::DiagnosticsTrace( prs::base& base )  // Diagnostics() call
 {
-    if( !GetParsed().count( OptionTrace ) )
+    if( !IsTrace() )
         return;
 
     base.GetParser()->setTrace( true );
@@ -210,8 +707,403 @@ void prs::executable::options::DiagnosticsTrace( prs::base& base )  // Diagnosti
 
 void prs::executable::options::DiagnosticsTree( prs::base& base )  // manual call
 {
-    if( !GetParsed().count( OptionTree ) || !base.GetLastParseTree() )
+    if( !IsTree() || !base.GetLastParseTree() )
+        return;
+
+    // printed as it goes, so deeply nested tree is never held as single string
+    prs::tree::Print( std::cout, base.GetLastParseTree(), {}, true );
+    std::cout << std::endl;
+}
+
+void prs::executable::options::DiagnosticsProfile( prs::base& base )  // Diagnostics() call
+{
+    if( !IsProfile() )
         return;
 
-    std::cout << base.GetLastParseTree()->toStringTree( true ) << std::endl;
+    std::string column = GetParsed()[OptionProfile].as<std::string>();
+    if( column != "rule" && std::none_of( ProfileColumns.begin(), ProfileColumns.end(), [&column]( const auto& entry ) { return entry.first == column; } ) )
+        ExitError( EXIT_FAILURE, "[Options] Unknown profile column <" + column + ">", Get().help() );
+
+    base.SetProfile( true );
+}
+
+void prs::executable::options::DiagnosticsProfileResult( prs::base& base )  // manual call
+{
+    if( !IsProfile() )
+        return;
+
+    std::vector<prs::decision_profile> profile = base.GetProfile();
+    std::string                        column  = GetParsed()[OptionProfile].as<std::string>();
+
+    // text column sorted ascending, numeric columns descending (most expensive first), except decision number
+    for( const auto& entry : ProfileColumns )
+    {
+        if( entry.first != column )
+            continue;
+
+        const auto& value = entry.second;
+        bool        desc  = column != "decision";
+        std::stable_sort( profile.begin(), profile.end(), [&value, desc]( const prs::decision_profile& left, const prs::decision_profile& right ) {
+            return desc ? value( left ) > value( right ) : value( left ) < value( right );
+        } );
+    }
+
+    if( column == "rule" )
+    {
+        std::stable_sort( profile.begin(), profile.end(), []( const prs::decision_profile& left, const prs::decision_profile& right ) {
+            return left.Rule < right.Rule;
+        } );
+    }
+
+    std::cout << "rule";
+    for( const auto& entry : ProfileColumns )
+        std::cout << '\t' << entry.first;
+    std::cout << '\n';
+
+    for( const auto& decision : profile )
+    {
+        std::cout << decision.Rule;
+        for( const auto& entry : ProfileColumns )
+            std::cout << '\t' << entry.second( decision );
+        std::cout << '\n';
+    }
+}
+
+void prs::executable::options::DiagnosticsMemstats( prs::base& base )  // manual call
+{
+    if( !IsMemstats() )
+        return;
+
+    base.SetProbe( [&base]( prs::phase step, bool start ) {
+        if( start )
+        {
+            if( step == prs::phase::Load )
+                Memstats.emplace_back();
+
+            MemstatsStart = prs::memory::Get();
+            return;
+        }
+
+        // counters must be read before anything else is allocated
+        prs::memory::stats stop = prs::memory::Get();
+
+        if( Memstats.empty() )
+            Memstats.emplace_back();
+
+        memstats_file&  file  = Memstats.back();
+        memstats_phase& stats = file.Phases[static_cast<size_t>( step )];
+
+        stats.Allocations += stop.Allocations - MemstatsStart.Allocations;
+        stats.Bytes += stop.Bytes - MemstatsStart.Bytes;
+        stats.PeakRSS = prs::memory::PeakRSS();
+
+        if( step == prs::phase::Load )
+        {
+            file.Filename = base.GetInput()->GetName();
+            stats.Units   = base.GetInput()->size();
+        }
+        else if( step == prs::phase::Lexing )
+            stats.Units = base.GetTokens()->size();
+        else if( step == prs::phase::Parsing )
+            stats.Units = CountNodes( base.GetLastParseTree() );
+    } );
+}
+
+void prs::executable::options::DiagnosticsMemstatsResult( prs::base& base )  // manual call
+{
+    if( !IsMemstats() )
+        return;
+
+    base.SetProbe( nullptr );
+
+    if( !prs::memory::IsHooked() )
+        prs::executable::Warning( "Allocations are not counted, executable built without PRS_MEMORY_HOOK" );
+
+    std::stable_sort( Memstats.begin(), Memstats.end(), []( const memstats_file& left, const memstats_file& right ) {
+        return left.Bytes() > right.Bytes();
+    } );
+
+    size_t limit = GetParsed()[OptionMemstats].as<size_t>();
+    if( Memstats.size() > limit )
+        Memstats.resize( limit );
+
+    std::cout << "file\tphase\tallocations\tbytes\tpeak-rss\tunits\tbytes-per-unit\n";
+    for( const auto& file : Memstats )
+    {
+        for( size_t idx = 0; idx < file.Phases.size(); idx++ )
+        {
+            const memstats_phase& stats = file.Phases[idx];
+
+            std::cout << file.Filename << '\t' << MemstatsPhases[idx] << '\t' << stats.Allocations << '\t' << stats.Bytes << '\t' << stats.PeakRSS << '\t' << stats.Units << '\t' << ( stats.Units ? stats.Bytes / stats.Units : 0 ) << '\n';
+        }
+    }
+}
+
+void prs::executable::options::DiagnosticsTraceEvents( prs::base& base )  // manual call
+{
+    if( !IsTraceEvents() )
+        return;
+
+    // events are recorded outside of chained probe (--memstats) measurements
+    base.SetProbe( [&base, chained = base.GetProbe()]( prs::phase step, bool start ) {
+        if( chained && !start )
+            chained( step, start );
+
+        trace_event event;
+        event.Name  = TraceEventsPhases[static_cast<size_t>( step )];
+        event.Begin = start;
+        event.Time  = prs::deadline::clock::now();
+
+        if( step == prs::phase::Parsing && base.GetParser()->getInterpreter<antlr4::atn::ParserATNSimulator>()->getPredictionMode() == antlr4::atn::PredictionMode::SLL )
+            event.Name = "parsing (SLL)";
+        else if( step == prs::phase::Load && !start )
+            event.File = base.GetInput()->GetName();
+
+        TraceEventsThread().Events.push_back( std::move( event ) );
+
+        if( chained && start )
+            chained( step, start );
+    } );
+}
+
+void prs::executable::options::DiagnosticsTraceEventsResult()  // manual call
+{
+    if( !IsTraceEvents() )
+        return;
+
+    std::lock_guard<std::mutex> lock( TraceEventsLock );
+
+    // timestamps are relative to first event, in microseconds
+    prs::deadline::clock::time_point start = prs::deadline::clock::time_point::max();
+    for( const auto& thread : TraceEventsThreads )
+    {
+        if( !thread->Events.empty() )
+            start = std::min( start, thread->Events.front().Time );
+    }
+
+    std::string   filename = GetParsed()[OptionTraceEvents].as<std::string>();
+    std::ofstream stream( filename, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc );
+
+    // events are written as they go, one per line, instead of building whole document first; buffer is reused by all events
+    std::string line;
+    bool        first = true;
+
+    stream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+    for( const auto& thread : TraceEventsThreads )
+    {
+        std::string tid = std::to_string( thread->Id );
+
+        line = first ? "\n" : ",\n";
+        line += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":";
+        line += tid;
+        line += ",\"args\":{\"name\":\"thread ";
+        line += tid;
+        line += "\"}}";
+        stream << line;
+
+        first = false;
+
+        for( const auto& event : thread->Events )
+        {
+            char ts[32];
+            auto [end, error] = std::to_chars( ts, ts + sizeof( ts ), std::chrono::duration<double, std::micro>( event.Time - start ).count(), std::chars_format::fixed, 3 );
+
+            line = ",\n{\"name\":";
+            prs::json::Escape( line, event.Name );
+            line += ",\"cat\":\"prs\",\"ph\":\"";
+            line += event.Begin ? 'B' : 'E';
+            line += "\",\"ts\":";
+            line.append( ts, end );
+            line += ",\"pid\":1,\"tid\":";
+            line += tid;
+
+            if( !event.File.empty() )
+            {
+                line += ",\"args\":{\"file\":";
+                prs::json::Escape( line, event.File );
+                line += '}';
+            }
+
+            line += '}';
+            stream << line;
+        }
+    }
+
+    stream << "\n]}\n";
+
+    if( !stream )
+        prs::executable::Error( "File cannot be written <" + filename + ">" );
+}
+
+void prs::executable::options::DiagnosticsCounters( prs::base& base )  // manual call
+{
+    if( !IsCounters() )
+        return;
+
+    Counters = std::make_unique<prs::counters::group>();
+    if( !Counters->Open() )
+    {
+        prs::executable::Warning( "Hardware performance counters are not available" );
+        Counters = nullptr;
+        return;
+    }
+
+    // counters are read as close to measured work as possible, inside of chained probe
+    base.SetProbe( [&base, chained = base.GetProbe()]( prs::phase step, bool start ) {
+        if( chained && start )
+            chained( step, start );
+
+        size_t idx = CountersPhase( base, step );
+
+        if( start )
+            CountersStart[idx] = Counters->Read();
+        else
+        {
+            CountersTotal[idx] += Counters->Read() - CountersStart[idx];
+
+            if( step == prs::phase::Load )
+            {
+                CountersTokens += CountersFileTokens;
+                CountersFileTokens = 0;
+                CountersChars += base.GetInput()->size();
+            }
+            else
+                CountersFileTokens = std::max( CountersFileTokens, base.GetTokens()->size() );
+        }
+
+        if( chained && !start )
+            chained( step, start );
+    } );
+}
+
+void prs::executable::options::DiagnosticsCountersResult()  // manual call
+{
+    if( !Counters )
+        return;
+
+    using prs::counters::counter;
+
+    CountersTokens += CountersFileTokens;
+    CountersFileTokens = 0;
+
+    // ratios are printed with two decimal places, counters not available are printed as n/a
+    auto ratio = []( bool available, double dividend, double divisor ) {
+        if( !available || divisor <= 0 )
+            return std::string( "n/a" );
+
+        std::ostringstream result;
+        result.setf( std::ios::fixed );
+        result.precision( 2 );
+        result << dividend / divisor;
+
+        return result.str();
+    };
+
+    auto print = [&ratio]( const std::string& name, const prs::counters::values& values ) {
+        double cycles       = static_cast<double>( values.Get( counter::Cycles ) );
+        double instructions = static_cast<double>( values.Get( counter::Instructions ) );
+
+        std::cout << name;
+        for( size_t idx = 0; idx < prs::counters::Count; idx++ )
+        {
+            counter which = static_cast<counter>( idx );
+
+            std::cout << '\t';
+            if( Counters->IsAvailable( which ) )
+                std::cout << values.Get( which );
+            else
+                std::cout << "n/a";
+        }
+
+        std::cout << '\t' << ratio( Counters->IsAvailable( counter::Cycles ) && Counters->IsAvailable( counter::Instructions ), instructions, cycles )
+                  << '\t' << ratio( Counters->IsAvailable( counter::Cycles ), cycles, static_cast<double>( CountersTokens ) )
+                  << '\t' << ratio( Counters->IsAvailable( counter::Instructions ), instructions, static_cast<double>( CountersTokens ) )
+                  << '\t' << ratio( Counters->IsAvailable( counter::Cycles ), cycles, static_cast<double>( CountersChars ) ) << '\n';
+    };
+
+    std::cout << "phase";
+    for( size_t idx = 0; idx < prs::counters::Count; idx++ )
+        std::cout << '\t' << prs::counters::Name( static_cast<counter>( idx ) );
+    std::cout << "\tipc\tcycles-per-token\tinstructions-per-token\tcycles-per-char\n";
+
+    prs::counters::values total;
+    for( size_t idx = 0; idx < CountersPhases.size(); idx++ )
+    {
+        print( CountersPhases[idx], CountersTotal[idx] );
+        total += CountersTotal[idx];
+    }
+    print( "total", total );
+
+    std::cout << "tokens\t" << CountersTokens << '\n'
+              << "chars\t" << CountersChars << '\n';
+}
+
+void prs::executable::options::DiagnosticsStartup( const std::string& stage )  // manual call
+{
+    auto now = prs::deadline::clock::now();
+
+    Startup.emplace_back( stage, std::chrono::duration<double>( now - StartupLast ).count() );
+    StartupLast = now;
+}
+
+void prs::executable::options::DiagnosticsStartupResult()  // manual call
+{
+    if( !IsStartup() )
+        return;
+
+    double total = 0;
+
+    std::cout << "stage\tseconds\n";
+    for( const auto& [stage, seconds] : Startup )
+    {
+        std::cout << stage << '\t' << seconds << '\n';
+        total += seconds;
+    }
+    std::cout << "total\t" << total << '\n';
+}
+
+bool prs::executable::options::IsTokens()
+{
+    return GetParsed().count( OptionTokens ) > 0;
+}
+
+bool prs::executable::options::IsTokensFull()
+{
+    return IsTokens() && GetParsed()[OptionTokens].as<std::string>() == "full";
+}
+
+bool prs::executable::options::IsTrace()
+{
+    return GetParsed().count( OptionTrace ) > 0;
+}
+
+bool prs::executable::options::IsTree()
+{
+    return GetParsed().count( OptionTree ) > 0;
+}
+
+bool prs::executable::options::IsProfile()
+{
+    return GetParsed().count( OptionProfile ) > 0;
+}
+
+bool prs::executable::options::IsMemstats()
+{
+    return GetParsed().count( OptionMemstats ) > 0;
+}
+
+bool prs::executable::options::IsStartup()
+{
+    return GetParsed().count( OptionStartup ) > 0;
+}
+
+bool prs::executable::options::IsTraceEvents()
+{
+    return GetParsed().count( OptionTraceEvents ) > 0;
+}
+
+bool prs::executable::options::IsCounters()
+{
+    return GetParsed().count( OptionCounters ) > 0;
 }
@@ -1,7 +1,9 @@
 #pragma once
 
+#include <memory>
 #include <source_location>
 #include <string>
+#include <vector>
 
 #include <cxxopts.hpp>
 
@@ -37,13 +39,83 @@ namespace prs::executable::options
 
     // general
 
+    // "-" reads standard input, see prs::LoadFile()
     void        AddFile();
     std::string File();
 
+    // performance budget, see .BUDGET files in CMake/CTestRunner.cmake
+    // budget file lists limits as `key = value` lines: time (calibration units), memory (peak RSS, MiB)
+    // calibration unit is median parsing time of calibration file with warm DFA, measured by --calibrate run on the same machine and read from --calibration file
+    // only lexing and parsing done by RunParserWithOptions() is counted, time budget is ignored with --trace
+    void AddBudget();
+    bool IsBudget();
+    bool IsCalibrate();
+    bool Calibrate( prs::base& base );  // manual call, parses File() and writes result to --calibrate file
+    bool BudgetResult();                // manual call, must be called after all files are processed; returns false if budget is exceeded
+
+    // per-file parsing time limit used by RunParserWithOptions(), in seconds; returns 0 if not set
+    void                           AddTimeout();
+    double                         Timeout();
+    std::unique_ptr<prs::deadline> Deadline();  // returns nullptr if not set
+
+    // errors are collected by prs::base instead of printed by antlr, and parsing is aborted after given number of them (0 = no limit)
+    // collected errors are printed by RunParserWithOptions(), in same format as antlr4::ConsoleErrorListener
+    void   AddErrorLimit();
+    bool   IsErrorLimit();
+    size_t ErrorLimit();  // returns 0 if not set
+
+    // parsing is aborted when rules are nested deeper than given level, instead of running out of stack; reported by RunParserWithOptions()
+    void   AddDepthLimit();
+    bool   IsDepthLimit();
+    size_t DepthLimit();  // returns 0 if not set
+
+    // --batch accepts directory (searched recursively for files with given extension), .dat archive (searched for entries with given extension) or file with list of paths
+    // if --batch is not used, returns File()
+    void                     AddBatch();
+    std::vector<std::string> Files( const std::string& extension );
+
     // diagnostics
 
     void AddGroupDiagnostics();
     void DiagnosticsTokens( prs::base& base );
     void DiagnosticsTrace( prs::base& base );
     void DiagnosticsTree( prs::base& base );
+    void DiagnosticsProfile( prs::base& base );
+
+    // prints profiling data as tab-separated values, sorted by column selected with --profile
+    // must be called manually after all files are processed, as data is accumulated between parsing runs
+    void DiagnosticsProfileResult( prs::base& base );
+
+    // installs probe collecting allocations and peak RSS of each phase, must be called manually before first LoadFile()
+    // results are printed as tab-separated values, files with most bytes allocated first
+    void DiagnosticsMemstats( prs::base& base );
+    void DiagnosticsMemstatsResult( prs::base& base );
+
+    // installs probe collecting hardware performance counters of each phase, chained with already installed one (if any)
+    // counters are per-thread, only work done by calling thread is counted; if counters are not available, warning is printed and nothing is installed
+    // results are printed as tab-separated values, totals and ratios per token and per input character
+    void DiagnosticsCounters( prs::base& base );
+    void DiagnosticsCountersResult();
+
+    // installs probe recording begin and end of each phase, chained with already installed one (if any)
+    // can be installed on multiple lib instances used by different threads; each thread records into its own buffer
+    // results are written to --trace-events file, must be called manually after all files are processed
+    void DiagnosticsTraceEvents( prs::base& base );
+    void DiagnosticsTraceEventsResult();
+
+    // marks end of startup stage, measured from Init() or previous mark; time spent before main() is not included
+    // results are printed as tab-separated values, if --startup is used
+    void DiagnosticsStartup( const std::string& stage );
+    void DiagnosticsStartupResult();
+
+    // diagnostics state, for front-ends not based on prs::base
+    bool IsTokens();
+    bool IsTokensFull();
+    bool IsTrace();
+    bool IsTree();
+    bool IsProfile();
+    bool IsMemstats();
+    bool IsStartup();
+    bool IsTraceEvents();
+    bool IsCounters();
 }  // namespace prs::executable::options
@@ -0,0 +1,194 @@
+#include <stdio.h>
+#include <string.h>
+
+#if defined( _WIN32 )
+    #include <windows.h>
+#else
+    #include <pthread.h>
+#endif
+
+#include "prs.capi.h"
+
+// C API test
+//
+// checks that Source/prs.capi.h compiles as C, and exercises prs.shared the way host programs use it:
+// valid and broken buffers, handle reused between calls, and one handle per thread
+//
+// PRS_CAPI_SAME_THREAD must be set when library uses thread-local ANTLR cache; handle used from other thread must be rejected then
+
+#define THREADS    4
+#define ITERATIONS 25
+
+static const char Valid[]  = "variable x := 1;\n\nprocedure start\nbegin\nend\n";
+static const char Broken[] = "procedure start\nbegin\n    ++;\nend\n";
+
+static int Failed = 0;
+
+static void Check( int condition, const char* what )
+{
+    if( condition )
+        return;
+
+    fprintf( stderr, "failed: %s\n", what );
+    Failed = 1;
+}
+
+// returns 0 if any check failed; checks are not reported here, as they might run on many threads at once
+static int ParseValid( prs_parser* parser )
+{
+    prs_options      options = { PRS_FLAG_TOKENS | PRS_FLAG_TREE, 0, 0 };
+    const prs_token* tokens  = NULL;
+    const prs_error* errors  = NULL;
+
+    if( prs_parse( parser, Valid, strlen( Valid ), "valid.ssl", &options ) != PRS_OK )
+        return 0;
+
+    size_t count = prs_tokens( parser, &tokens );
+    if( count == 0 || !tokens || strcmp( tokens[0].text, "variable" ) != 0 || tokens[0].line != 1 || tokens[0].column != 1 )
+        return 0;
+
+    return prs_errors( parser, &errors ) == 0 && strlen( prs_tree( parser ) ) > 0;
+}
+
+static int ParseBroken( prs_parser* parser )
+{
+    const prs_token* tokens = NULL;
+    const prs_error* errors = NULL;
+
+    if( prs_parse( parser, Broken, strlen( Broken ), "broken.ssl", NULL ) != PRS_SYNTAX )
+        return 0;
+
+    size_t count = prs_errors( parser, &errors );
+    if( count == 0 || !errors || errors[0].line != 3 || errors[0].column == 0 || !errors[0].message || !errors[0].token )
+        return 0;
+
+    // no flags, nothing else is collected
+    return prs_tokens( parser, &tokens ) == 0 && strlen( prs_tree( parser ) ) == 0;
+}
+
+//
+// threads
+//
+
+typedef struct worker
+{
+    prs_parser* Shared;  // created by main thread, passed to single worker only
+    int         Result;
+    int         SharedResult;
+} worker;
+
+static void Work( worker* self )
+{
+    prs_parser* parser = prs_create();
+
+    self->Result = parser != NULL;
+    for( int idx = 0; self->Result && idx < ITERATIONS; idx++ )
+        self->Result = ParseValid( parser ) && ParseBroken( parser );
+
+    prs_destroy( parser );
+
+    if( self->Shared )
+        self->SharedResult = prs_parse( self->Shared, Valid, strlen( Valid ), "valid.ssl", NULL );
+}
+
+#if defined( _WIN32 )
+static DWORD WINAPI WorkThread( LPVOID arg )
+{
+    Work( ( worker* )arg );
+    return 0;
+}
+#else
+static void* WorkThread( void* arg )
+{
+    Work( ( worker* )arg );
+    return NULL;
+}
+#endif
+
+static void RunThreads( prs_parser* shared )
+{
+    worker workers[THREADS];
+    int    started[THREADS];
+
+#if defined( _WIN32 )
+    HANDLE threads[THREADS];
+#else
+    pthread_t threads[THREADS];
+#endif
+
+    for( int idx = 0; idx < THREADS; idx++ )
+    {
+        workers[idx].Shared       = idx == 0 ? shared : NULL;
+        workers[idx].Result       = 0;
+        workers[idx].SharedResult = PRS_INVALID;
+
+#if defined( _WIN32 )
+        threads[idx] = CreateThread( NULL, 0, WorkThread, &workers[idx], 0, NULL );
+        started[idx] = threads[idx] != NULL;
+#else
+        started[idx] = pthread_create( &threads[idx], NULL, WorkThread, &workers[idx] ) == 0;
+#endif
+        Check( started[idx], "thread started" );
+    }
+
+    for( int idx = 0; idx < THREADS; idx++ )
+    {
+        if( !started[idx] )
+            continue;
+
+#if defined( _WIN32 )
+        WaitForSingleObject( threads[idx], INFINITE );
+        CloseHandle( threads[idx] );
+#else
+        pthread_join( threads[idx], NULL );
+#endif
+
+        Check( workers[idx].Result, "handle per thread" );
+
+        if( !workers[idx].Shared )
+            continue;
+
+#if PRS_CAPI_SAME_THREAD
+        Check( workers[idx].SharedResult == PRS_INVALID, "handle used outside of creating thread is rejected" );
+#else
+        Check( workers[idx].SharedResult == PRS_OK, "handle used outside of creating thread" );
+#endif
+    }
+}
+
+//
+
+int main( void )
+{
+    Check( prs_version() > 0, "version" );
+
+    prs_parser* parser = prs_create();
+    if( !parser )
+    {
+        fprintf( stderr, "failed: create\n" );
+        return 1;
+    }
+
+    Check( ParseValid( parser ), "valid buffer" );
+    Check( ParseBroken( parser ), "broken buffer" );
+
+    // results of previous call must not leak into next one
+    Check( ParseValid( parser ), "valid buffer after broken one" );
+    Check( ParseValid( parser ), "valid buffer again" );
+
+    Check( prs_parse( parser, NULL, 1, NULL, NULL ) == PRS_INVALID && strlen( prs_last_error( parser ) ) > 0, "invalid arguments" );
+    Check( prs_parse( parser, "", 0, NULL, NULL ) == PRS_OK, "empty buffer" );
+    Check( strcmp( prs_token_name( parser, ( size_t )-1 ), "" ) == 0, "unknown token name" );
+
+    RunThreads( parser );
+
+    // after other threads used (or tried to use) it
+    Check( ParseValid( parser ), "valid buffer after threads" );
+
+    prs_destroy( parser );
+
+    if( !Failed )
+        printf( "passed\n" );
+
+    return Failed;
+}
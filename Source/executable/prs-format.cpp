@@ -0,0 +1,299 @@
+#include <atomic>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#if defined( _WIN32 )
+    #include <fcntl.h>
+    #include <io.h>
+#endif
+
+#include "executable.hpp"
+#include "prs.hpp"
+#include "prs.parallel.hpp"
+#include "prs.ssl.hpp"
+
+// SSL formatter
+//
+// token stream keeps every blank and comment, so output is written straight from tokens, in single pass, without parsing;
+// only whitespace is changed, all other tokens are copied as-is
+//   indentation is set from begin/end nesting
+//   trailing whitespace is removed, runs of spaces and tabs inside line are replaced with single space
+//   there's no space after '(', and before ')', ';', '++', or '(' following name
+//   blank lines at start and end of file are removed, runs of blank lines are replaced with single one
+//   line endings are kept
+//
+// files with lexer errors are not formatted, as some of their content would be lost
+//
+// --golden compares output with .formatted file next to source, byte for byte, and checks that formatting output again doesn't change it
+
+namespace
+{
+    using ssl_lib = prs::lib<prs::ssl::Lexer, prs::ssl::Parser>;
+
+    const std::string OptionIndent  = "indent";
+    const std::string OptionInPlace = "in-place";
+    const std::string OptionCheck   = "check";
+    const std::string OptionGolden  = "golden";
+    const std::string OptionThreads = "threads";
+
+    struct outcome
+    {
+        bool        Loaded  = false;
+        bool        Lexed   = false;
+        bool        Changed = false;
+        bool        Written = true;
+        bool        Golden  = true;  // output matches golden file
+        bool        Stable  = true;  // formatting output again doesn't change it
+        std::string Output  = {};
+    };
+
+    std::string GoldenName( const std::string& filename )
+    {
+        return std::filesystem::path( filename ).replace_extension( ".formatted" ).string();
+    }
+
+    bool Golden( const std::string& filename, const std::string& output )
+    {
+        std::ifstream stream( filename, std::ios_base::in | std::ios_base::binary );
+        if( !stream )
+            return false;
+
+        std::string expected( ( std::istreambuf_iterator<char>( stream ) ), std::istreambuf_iterator<char>() );
+
+        return expected == output;
+    }
+
+    bool IsBlank( size_t type )
+    {
+        return type == prs::ssl::Lexer::SPACE || type == prs::ssl::Lexer::TAB;
+    }
+
+    bool IsEol( size_t type )
+    {
+        return type == prs::ssl::Lexer::EOL_DOS || type == prs::ssl::Lexer::EOL_UNIX;
+    }
+
+    bool IsSpaceAllowed( size_t previous, size_t type )
+    {
+        if( previous == prs::ssl::Lexer::PAREN_OPEN )
+            return false;
+        else if( type == prs::ssl::Lexer::PAREN_OPEN )
+            return previous != prs::ssl::Lexer::IDENTIFIER;
+
+        return type != prs::ssl::Lexer::PAREN_CLOSE && type != prs::ssl::Lexer::SEMICOLON && type != prs::ssl::Lexer::OP_INCREASE;
+    }
+
+    // token text is appended directly from input, without temporary strings
+    std::string Format( prs::base& base, size_t indent, size_t size )
+    {
+        std::string result;
+        result.reserve( size + size / 8 );
+
+        size_t      depth     = 0;
+        size_t      previous  = antlr4::Token::INVALID_TYPE;
+        bool        lineStart = true;   // nothing written in current line yet
+        bool        space     = false;  // blanks found after previous token in current line
+        std::string blankLine = {};     // line ending of first blank line, written only if followed by something
+
+        for( const auto* token : base.GetTokens()->getTokens() )
+        {
+            size_t type = token->getType();
+
+            if( type == antlr4::Token::EOF )
+                break;
+            else if( IsBlank( type ) )
+            {
+                space = !lineStart;
+                continue;
+            }
+            else if( IsEol( type ) )
+            {
+                if( !lineStart )
+                    result += base.GetTokenText( token );
+                else if( blankLine.empty() && !result.empty() )
+                    blankLine = base.GetTokenText( token );
+
+                lineStart = true;
+                space     = false;
+                continue;
+            }
+
+            if( type == prs::ssl::Lexer::END && depth > 0 )
+                depth--;
+
+            if( lineStart )
+            {
+                result += blankLine;
+                result.append( depth * indent, ' ' );
+                blankLine.clear();
+            }
+            else if( space && IsSpaceAllowed( previous, type ) )
+                result += ' ';
+
+            result += base.GetTokenText( token );
+
+            if( type == prs::ssl::Lexer::BEGIN )
+                depth++;
+
+            previous  = type;
+            lineStart = false;
+            space     = false;
+        }
+
+        return result;
+    }
+}  // namespace
+
+int main( int argc, char** argv )
+{
+    prs::executable::Init( argc, argv, "SSL formatter" );
+    {
+        prs::executable::options::AddFile();
+        prs::executable::options::AddBatch();
+
+        auto option = prs::executable::options::Get().add_options( "Format" );
+        option( OptionIndent, "Indentation size", cxxopts::value<size_t>()->default_value( "4" ) );
+        option( OptionInPlace, "Overwrite files which needs formatting" );
+        option( OptionCheck, "Only report files which needs formatting" );
+        option( OptionGolden, "Compare output with .formatted file next to source file, instead of printing it" );
+        option( OptionThreads, "Number of threads (0 = all cores)", cxxopts::value<size_t>()->default_value( "0" ) );
+    }
+
+    auto&                    parsed  = prs::executable::options::GetParsed();
+    std::vector<std::string> files   = prs::executable::options::Files( "ssl" );
+    size_t                   indent  = parsed[OptionIndent].as<size_t>();
+    bool                     inPlace = parsed.count( OptionInPlace ) > 0;
+    bool                     check   = parsed.count( OptionCheck ) > 0;
+    bool                     golden  = parsed.count( OptionGolden ) > 0;
+
+    if( inPlace + check + golden > 1 )
+    {
+        prs::executable::Error( "Options <" + OptionInPlace + ">, <" + OptionCheck + "> and <" + OptionGolden + "> cannot be used together" );
+        return EXIT_FAILURE;
+    }
+    else if( !inPlace && !check && !golden && files.size() > 1 )
+    {
+        prs::executable::Error( "Formatting multiple files requires <" + OptionInPlace + "> or <" + OptionCheck + ">" );
+        return EXIT_FAILURE;
+    }
+
+    std::vector<outcome> outcomes( files.size() );
+    std::atomic<size_t>  nextFile = 0;
+
+    prs::parallel::Pool( prs::parallel::Threads( parsed[OptionThreads].as<size_t>(), files.size() ), [&]() {
+        ssl_lib                  ssl;
+        prs::parallel::collector errors;
+
+        ssl.GetLexer()->removeErrorListeners();
+        ssl.GetLexer()->addErrorListener( &errors );
+
+        std::string content;
+        for( size_t idx = nextFile++; idx < files.size(); idx = nextFile++ )
+        {
+            outcome& current = outcomes[idx];
+
+            current.Loaded = prs::LoadFile( files[idx], content );
+            if( !current.Loaded )
+                continue;
+
+            errors.Clear();
+            ssl.LoadBuffer( content, files[idx] );
+            ssl.FillTokens();
+
+            current.Lexed = errors.Get().empty();
+            if( !current.Lexed )
+                continue;
+
+            current.Output  = Format( ssl, indent, content.size() );
+            current.Changed = current.Output != content;
+
+            if( inPlace && current.Changed )
+            {
+                std::ofstream stream( files[idx], std::ios_base::out | std::ios_base::binary | std::ios_base::trunc );
+                current.Written = static_cast<bool>( stream << current.Output );
+            }
+
+            if( golden )
+            {
+                current.Golden = Golden( GoldenName( files[idx] ), current.Output );
+
+                ssl.LoadBuffer( current.Output, files[idx] );
+                ssl.FillTokens();
+                current.Stable = Format( ssl, indent, current.Output.size() ) == current.Output;
+            }
+
+            // keep memory usage low on large batches
+            if( inPlace || check || golden )
+                current.Output.clear();
+        }
+
+        ssl.UnloadFile();
+        ssl.GetLexer()->removeErrorListener( &errors );
+    } );
+
+    bool   result  = true;
+    size_t changed = 0;
+    for( size_t idx = 0; idx < files.size(); idx++ )
+    {
+        const outcome& current = outcomes[idx];
+
+        if( !current.Loaded )
+        {
+            prs::executable::Error( "File cannot be loaded <" + files[idx] + ">" );
+            result = false;
+        }
+        else if( !current.Lexed )
+        {
+            prs::executable::Error( "File cannot be tokenized <" + files[idx] + ">" );
+            result = false;
+        }
+        else if( !current.Written )
+        {
+            prs::executable::Error( "File cannot be written <" + files[idx] + ">" );
+            result = false;
+        }
+        else if( golden )
+        {
+            if( !current.Golden )
+            {
+                std::string name = GoldenName( files[idx] );
+                prs::executable::Error( std::string( std::filesystem::exists( name ) ? "Output differs from golden file <" : "Golden file does not exist <" ) + name + ">" );
+                result = false;
+            }
+
+            if( !current.Stable )
+            {
+                prs::executable::Error( "Formatting output again changes it <" + files[idx] + ">" );
+                result = false;
+            }
+        }
+        else if( current.Changed )
+        {
+            changed++;
+
+            if( check )
+            {
+                prs::executable::Error( "File needs formatting <" + files[idx] + ">" );
+                result = false;
+            }
+        }
+    }
+
+    if( inPlace )
+        prs::executable::Notice( "Formatted " + std::to_string( changed ) + " of " + std::to_string( files.size() ) + " file(s)" );
+    else if( !check && !golden && result && !outcomes.empty() )
+    {
+#if defined( _WIN32 )
+        // line endings must not be translated
+        _setmode( _fileno( stdout ), _O_BINARY );
+#endif
+        std::cout << outcomes.front().Output;
+    }
+
+    return result ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,574 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "executable.hpp"
+#include "prs.counters.hpp"
+#include "prs.hpp"
+#include "prs.memory.hpp"
+#include "prs.parallel.hpp"
+#include "prs.ssl.hpp"
+#include "prs.tree.hpp"
+
+#if defined( PRS_PEGTL )
+    #include "prs.pegtl.ssl.hpp"
+#endif
+
+namespace
+{
+    const std::string OptionIterations = "iterations";
+    const std::string OptionBackend    = "backend";
+    const std::string OptionChunk      = "parallel-chunk";
+    const std::string OptionWalk       = "walk";
+    const std::string OptionThreads    = "threads";
+    const std::string OptionCounters   = "counters";
+    const std::string OptionDepth      = "depth";
+
+    // used by --depth if --depth-limit is not set, deeper input would run out of stack while parsing
+    constexpr size_t DefaultDepthLimit = 2000;
+
+    struct result
+    {
+        std::string       Backend;
+        double            Seconds = 0;
+        std::vector<bool> Verdicts;
+
+        prs::counters::values Counters;
+    };
+
+    using runner = std::function<bool( const std::string& filename )>;
+
+    // counters are optional, and count work done by calling thread only
+    result Run( const std::string& backend, const std::vector<std::string>& files, size_t iterations, const runner& run, const prs::counters::group* counters )
+    {
+        result result;
+        result.Backend = backend;
+
+        // first iteration is not measured, so both backends starts with warm file cache, and antlr with warm DFA
+        for( const auto& filename : files )
+            result.Verdicts.push_back( run( filename ) );
+
+        prs::counters::values counted = counters ? counters->Read() : prs::counters::values();
+        auto                  start   = std::chrono::steady_clock::now();
+        for( size_t iteration = 0; iteration < iterations; iteration++ )
+        {
+            for( const auto& filename : files )
+                run( filename );
+        }
+        result.Seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+        if( counters )
+            result.Counters = counters->Read() - counted;
+
+        return result;
+    }
+
+    // walkers are counting nodes, with single rule handler so dispatch cannot be skipped
+
+    struct count
+    {
+        size_t Rules      = 0;
+        size_t Terminals  = 0;
+        size_t Procedures = 0;
+
+        bool operator==( const count& ) const = default;
+    };
+
+    class count_listener final : public prs::ssl::Listener
+    {
+    public:
+        count Count = {};
+
+        virtual void enterEveryRule( antlr4::ParserRuleContext* ) override { Count.Rules++; }
+        virtual void visitTerminal( antlr4::tree::TerminalNode* ) override { Count.Terminals++; }
+        virtual void enterProcedureBody( prs::ssl::Parser::ProcedureBodyContext* ) override { Count.Procedures++; }
+    };
+
+    class count_walker final : public prs::ssl::Walker<count_walker>
+    {
+    public:
+        count Count = {};
+
+        void EnterEveryRule( antlr4::ParserRuleContext* ) { Count.Rules++; }
+        void VisitTerminal( antlr4::tree::TerminalNode* ) { Count.Terminals++; }
+        void EnterProcedureBody( prs::ssl::Parser::ProcedureBodyContext* ) { Count.Procedures++; }
+    };
+
+    // compares full tree walk of antlr4::tree::ParseTreeWalker and generated walker, parsing time is not measured
+    int Walk( const std::vector<std::string>& files, size_t iterations )
+    {
+        prs::lib<prs::ssl::Lexer, prs::ssl::Parser> ssl;
+        ssl.GetParser()->removeErrorListeners();
+
+        double listenerSeconds = 0;
+        double walkerSeconds   = 0;
+        size_t nodes           = 0;
+        bool   same            = true;
+
+        for( const auto& filename : files )
+        {
+            if( !ssl.LoadFile( filename ) || !ssl.ParseAdaptive() )
+            {
+                prs::executable::Warning( "File skipped <" + filename + ">" );
+                continue;
+            }
+
+            antlr4::tree::ParseTree* tree = ssl.GetLastParseTree();
+            count_listener           listener;
+            count_walker             walker;
+
+            // first walk is not measured
+            antlr4::tree::ParseTreeWalker::DEFAULT.walk( &listener, tree );
+            walker.Walk( tree );
+
+            if( listener.Count != walker.Count )
+            {
+                prs::executable::Error( "Walkers mismatch <" + filename + ">" );
+                same = false;
+            }
+
+            nodes += listener.Count.Rules + listener.Count.Terminals;
+
+            auto start = std::chrono::steady_clock::now();
+            for( size_t iteration = 0; iteration < iterations; iteration++ )
+                antlr4::tree::ParseTreeWalker::DEFAULT.walk( &listener, tree );
+            listenerSeconds += std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+            start = std::chrono::steady_clock::now();
+            for( size_t iteration = 0; iteration < iterations; iteration++ )
+                walker.Walk( tree );
+            walkerSeconds += std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+        }
+
+        std::cout << std::left << std::setw( 16 ) << "walker" << std::right
+                  << std::setw( 14 ) << "nodes"
+                  << std::setw( 12 ) << "iterations"
+                  << std::setw( 14 ) << "total [ms]"
+                  << std::setw( 14 ) << "node [ns]" << '\n';
+
+        for( const auto& [name, seconds] : { std::pair{ "listener", listenerSeconds }, std::pair{ "walker", walkerSeconds } } )
+        {
+            double visits = static_cast<double>( nodes * iterations );
+
+            std::cout << std::left << std::setw( 16 ) << name << std::right << std::fixed << std::setprecision( 2 )
+                      << std::setw( 14 ) << nodes
+                      << std::setw( 12 ) << iterations
+                      << std::setw( 14 ) << seconds * 1000
+                      << std::setw( 14 ) << ( visits > 0 ? seconds * 1000000000 / visits : 0 ) << '\n';
+        }
+
+        return same ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    // nested blocks, each level adds block, blockBody and procedure_scope rules
+    std::string NestedScript( size_t depth )
+    {
+        std::string result = "procedure start begin\n";
+        for( size_t level = 0; level < depth; level++ )
+            result += "if true then begin\n";
+        for( size_t level = 0; level < depth; level++ )
+            result += "end\n";
+
+        return result + "end\n";
+    }
+
+    // same shape as nested blocks, without parsing; nodes are owned by caller
+    antlr4::tree::ParseTree* NestedTree( size_t depth, std::vector<std::unique_ptr<antlr4::tree::ParseTree>>& nodes, antlr4::Token* token )
+    {
+        auto add = [&nodes]( antlr4::tree::ParseTree* parent, std::unique_ptr<antlr4::tree::ParseTree> child ) {
+            child->parent = parent;
+            if( parent )
+                parent->children.push_back( child.get() );
+
+            nodes.push_back( std::move( child ) );
+            return nodes.back().get();
+        };
+
+        antlr4::tree::ParseTree* root = add( nullptr, std::make_unique<antlr4::ParserRuleContext>() );
+        antlr4::tree::ParseTree* last = root;
+        for( size_t level = 0; level < depth * 3; level++ )
+        {
+            add( last, std::make_unique<antlr4::tree::TerminalNodeImpl>( token ) );
+            last = add( last, std::make_unique<antlr4::ParserRuleContext>() );
+        }
+        add( last, std::make_unique<antlr4::tree::TerminalNodeImpl>( token ) );
+
+        return root;
+    }
+
+    // compares parsing and tree traversal as nesting grows
+    // parsing is recursive and stops at nesting limit; traversal is measured on tree of same shape built without parser, so it's done at every depth
+    int Depth( const std::vector<size_t>& depths, size_t iterations, size_t limit )
+    {
+        prs::lib<prs::ssl::Lexer, prs::ssl::Parser> ssl;
+        ssl.GetParser()->removeErrorListeners();
+        ssl.SetDepthLimit( limit );
+
+        antlr4::CommonToken token( prs::ssl::Lexer::IDENTIFIER, "x" );
+
+        std::cout << std::right
+                  << std::setw( 10 ) << "depth"
+                  << std::setw( 10 ) << "rules"
+                  << std::setw( 12 ) << "nodes"
+                  << std::setw( 14 ) << "parse [ms]"
+                  << std::setw( 14 ) << "walker [ms]"
+                  << std::setw( 14 ) << "walk [ms]"
+                  << std::setw( 14 ) << "print [ms]" << '\n';
+
+        for( size_t depth : depths )
+        {
+            std::string content = NestedScript( depth );
+            bool        parsed  = true;
+
+            auto start = std::chrono::steady_clock::now();
+            for( size_t iteration = 0; parsed && iteration < iterations; iteration++ )
+            {
+                ssl.LoadBuffer( content, "depth." + std::to_string( depth ) );
+                parsed = ssl.ParseAdaptive();
+            }
+            double parseSeconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+            if( !parsed && !ssl.IsDepthLimitReached() )
+            {
+                prs::executable::Error( "Nested script cannot be parsed <depth." + std::to_string( depth ) + ">" );
+                return EXIT_FAILURE;
+            }
+
+            std::vector<std::unique_ptr<antlr4::tree::ParseTree>> nodes;
+            antlr4::tree::ParseTree*                              tree = NestedTree( depth, nodes, &token );
+            count_listener                                        listener;
+            count_walker                                          walker;
+            std::ostringstream                                    output;
+
+            start = std::chrono::steady_clock::now();
+            for( size_t iteration = 0; iteration < iterations; iteration++ )
+                walker.Walk( tree );
+            double walkerSeconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+            start = std::chrono::steady_clock::now();
+            for( size_t iteration = 0; iteration < iterations; iteration++ )
+                prs::tree::Walk( listener, tree );
+            double walkSeconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+            start = std::chrono::steady_clock::now();
+            for( size_t iteration = 0; iteration < iterations; iteration++ )
+            {
+                output.str( std::string() );
+                prs::tree::Print( output, tree );
+            }
+            double printSeconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+            double runs = static_cast<double>( iterations );
+
+            std::cout << std::right << std::fixed << std::setprecision( 2 )
+                      << std::setw( 10 ) << depth
+                      << std::setw( 10 ) << prs::tree::Depth( tree )
+                      << std::setw( 12 ) << nodes.size();
+
+            if( parsed )
+                std::cout << std::setw( 14 ) << parseSeconds * 1000 / runs;
+            else
+                std::cout << std::setw( 14 ) << "limit";
+
+            std::cout << std::setw( 14 ) << walkerSeconds * 1000 / runs
+                      << std::setw( 14 ) << walkSeconds * 1000 / runs
+                      << std::setw( 14 ) << printSeconds * 1000 / runs << '\n';
+        }
+
+        ssl.UnloadFile();
+
+        return EXIT_SUCCESS;
+    }
+
+    // compares throughput, warm-up and memory usage of antlr DFA cache as number of threads grows
+    // each thread parses all files in every iteration, with its own lib instance; first iteration starts with empty DFA
+    // cache mode is selected at build time, see PRS_ANTLR_THREAD_LOCAL_CACHE
+    int Scaling( const std::vector<std::string>& files, size_t iterations, const std::vector<size_t>& counts )
+    {
+        using ssl_lib = prs::lib<prs::ssl::Lexer, prs::ssl::Parser>;
+
+        std::vector<std::string> contents( files.size() );
+        size_t                   bytes = 0;
+        for( size_t idx = 0; idx < files.size(); idx++ )
+        {
+            if( !prs::LoadFile( files[idx], contents[idx] ) )
+            {
+                prs::executable::Error( "File cannot be loaded <" + files[idx] + ">" );
+                return EXIT_FAILURE;
+            }
+
+            bytes += contents[idx].size();
+        }
+
+        if( !prs::memory::IsHooked() )
+            prs::executable::Warning( "Allocations are not counted, executable built without PRS_MEMORY_HOOK" );
+
+        prs::executable::Notice( std::string( "DFA cache: " ) + ( ANTLR4_USE_THREAD_LOCAL_CACHE ? "thread-local" : "shared" ) );
+
+        std::cout << std::right
+                  << std::setw( 8 ) << "threads"
+                  << std::setw( 14 ) << "first [ms]"
+                  << std::setw( 14 ) << "warm [ms]"
+                  << std::setw( 14 ) << "total [ms]"
+                  << std::setw( 12 ) << "MiB/s"
+                  << std::setw( 14 ) << "alloc [MiB]"
+                  << std::setw( 14 ) << "peak [MiB]" << '\n';
+
+        for( size_t count : counts )
+        {
+            count = prs::parallel::Threads( count, std::numeric_limits<size_t>::max() );
+
+            // with shared cache, this clears DFA used by all threads; with thread-local cache, only calling thread needs it, as others are started from scratch
+            {
+                ssl_lib ssl;
+                ssl.GetLexer()->getInterpreter<antlr4::atn::LexerATNSimulator>()->clearDFA();
+                ssl.GetParser()->getInterpreter<antlr4::atn::ParserATNSimulator>()->clearDFA();
+            }
+
+            std::vector<double> first( count, 0 );
+            std::vector<double> warm( count, 0 );
+            std::atomic<size_t> nextThread = 0;
+
+            prs::memory::stats memory = prs::memory::Get();
+            auto               start  = std::chrono::steady_clock::now();
+
+            prs::parallel::Pool( count, [&]() {
+                size_t  thread = nextThread++;
+                ssl_lib ssl;
+
+                ssl.GetLexer()->removeErrorListeners();
+                ssl.GetParser()->removeErrorListeners();
+
+                for( size_t iteration = 0; iteration < iterations; iteration++ )
+                {
+                    auto iterationStart = std::chrono::steady_clock::now();
+                    for( size_t idx = 0; idx < contents.size(); idx++ )
+                    {
+                        ssl.LoadBuffer( contents[idx], files[idx] );
+                        ssl.ParseAdaptive();
+                    }
+
+                    double seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - iterationStart ).count();
+                    ( iteration == 0 ? first[thread] : warm[thread] ) += seconds;
+                }
+
+                ssl.UnloadFile();
+            } );
+
+            double seconds   = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+            double allocated = static_cast<double>( prs::memory::Get().Bytes - memory.Bytes );
+            double warmRuns  = static_cast<double>( count * ( iterations - 1 ) );
+            double total     = static_cast<double>( bytes * iterations * count );
+
+            std::cout << std::right << std::fixed << std::setprecision( 2 )
+                      << std::setw( 8 ) << count
+                      << std::setw( 14 ) << *std::max_element( first.begin(), first.end() ) * 1000
+                      << std::setw( 14 ) << ( warmRuns > 0 ? std::accumulate( warm.begin(), warm.end(), 0.0 ) * 1000 / warmRuns : 0 )
+                      << std::setw( 14 ) << seconds * 1000
+                      << std::setw( 12 ) << ( seconds > 0 ? total / ( 1024 * 1024 ) / seconds : 0 )
+                      << std::setw( 14 ) << allocated / ( 1024 * 1024 )
+                      << std::setw( 14 ) << static_cast<double>( prs::memory::PeakRSS() ) / ( 1024 * 1024 ) << '\n';
+        }
+
+        return EXIT_SUCCESS;
+    }
+}  // namespace
+
+int main( int argc, char** argv )
+{
+    prs::executable::Init( argc, argv, "SSL parser benchmark" );
+    {
+        prs::executable::options::AddFile();
+        prs::executable::options::AddBatch();
+        prs::executable::options::AddDepthLimit();
+
+        auto option = prs::executable::options::Get().add_options( "Benchmark" );
+        option( OptionIterations, "Number of measured iterations", cxxopts::value<size_t>()->default_value( "10" ) );
+        option( OptionBackend, "Backends to compare (antlr, antlr-parallel, pegtl)", cxxopts::value<std::vector<std::string>>()->default_value( "antlr,pegtl" ) );
+        option( OptionChunk, "Minimal part size used by antlr-parallel (bytes)", cxxopts::value<size_t>()->default_value( "65536" ) );
+        option( OptionWalk, "Compare parse tree walkers instead of backends" );
+        option( OptionCounters, "Report hardware performance counters per byte (Linux only, calling thread only)" );
+        option( OptionDepth, "Compare parsing and tree traversal over given nesting depths, instead of backends; files are not used", cxxopts::value<std::vector<size_t>>()->implicit_value( "10,100,1000,10000,100000" ) );
+        option( OptionThreads, "Compare antlr DFA cache scaling over given numbers of threads (0 = all cores) instead of backends", cxxopts::value<std::vector<size_t>>() );
+    }
+
+    size_t iterations = prs::executable::options::GetParsed()[OptionIterations].as<size_t>();
+
+    if( prs::executable::options::GetParsed().count( OptionDepth ) )
+    {
+        size_t limit = prs::executable::options::IsDepthLimit() ? prs::executable::options::DepthLimit() : DefaultDepthLimit;
+
+        return Depth( prs::executable::options::GetParsed()[OptionDepth].as<std::vector<size_t>>(), std::max( iterations, size_t( 1 ) ), limit );
+    }
+
+    std::vector<std::string> files    = prs::executable::options::Files( "ssl" );
+    std::vector<std::string> backends = prs::executable::options::GetParsed()[OptionBackend].as<std::vector<std::string>>();
+
+    if( prs::executable::options::GetParsed().count( OptionWalk ) )
+        return Walk( files, iterations );
+
+    if( prs::executable::options::GetParsed().count( OptionThreads ) )
+    {
+        if( iterations < 2 )
+        {
+            prs::executable::Error( "Option <" + OptionThreads + "> requires at least 2 iterations" );
+            return EXIT_FAILURE;
+        }
+
+        return Scaling( files, iterations, prs::executable::options::GetParsed()[OptionThreads].as<std::vector<size_t>>() );
+    }
+
+    // backends are loading files on every iteration, so standard input would be empty after first one
+    // size is taken from loaded content, as archive entries have no size on disk
+    size_t bytes = 0;
+    for( const auto& filename : files )
+    {
+        std::string content;
+
+        if( filename == "-" )
+        {
+            prs::executable::Error( "Standard input cannot be used for benchmark, it can be read only once" );
+            return EXIT_FAILURE;
+        }
+
+        if( !prs::LoadFile( filename, content ) )
+        {
+            prs::executable::Error( "File cannot be loaded <" + filename + ">" );
+            return EXIT_FAILURE;
+        }
+
+        bytes += content.size();
+    }
+
+    std::unique_ptr<prs::counters::group> counters;
+    if( prs::executable::options::GetParsed().count( OptionCounters ) )
+    {
+        counters = std::make_unique<prs::counters::group>();
+        if( !counters->Open() )
+        {
+            prs::executable::Warning( "Hardware performance counters are not available" );
+            counters = nullptr;
+        }
+    }
+
+    std::vector<result> results;
+    for( const auto& backend : backends )
+    {
+        std::unique_ptr<prs::frontend> frontend;
+
+        if( backend == "antlr" )
+        {
+            auto ssl = std::make_unique<prs::lib<prs::ssl::Lexer, prs::ssl::Parser>>();
+            ssl->GetParser()->removeErrorListeners();
+
+            frontend = std::move( ssl );
+        }
+        else if( backend == "antlr-parallel" )
+        {
+            size_t chunk = prs::executable::options::GetParsed()[OptionChunk].as<size_t>();
+
+            // workers are kept between files and iterations, same as lib instance used by other backends
+            prs::parallel::pool workers( []() { return std::make_unique<prs::lib<prs::ssl::Lexer, prs::ssl::Parser>>(); } );
+
+            results.push_back( Run( backend, files, iterations, [chunk, &workers]( const std::string& filename ) {
+                std::string content;
+
+                return prs::LoadFile( filename, content ) && workers.Parse( content, chunk ).Success;
+            }, counters.get() ) );
+        }
+#if defined( PRS_PEGTL )
+        else if( backend == "pegtl" )
+            frontend = std::make_unique<prs::pegtl::ssl::lib>();
+#endif
+        else
+            prs::executable::Warning( "Unknown or disabled backend <" + backend + ">" );
+
+        if( frontend )
+        {
+            results.push_back( Run( backend, files, iterations, [&frontend]( const std::string& filename ) {
+                return frontend->LoadFile( filename ) && frontend->ParseAdaptive();
+            }, counters.get() ) );
+        }
+    }
+
+    std::cout << std::left << std::setw( 16 ) << "backend" << std::right
+              << std::setw( 10 ) << "files"
+              << std::setw( 14 ) << "bytes"
+              << std::setw( 12 ) << "iterations"
+              << std::setw( 14 ) << "total [ms]"
+              << std::setw( 14 ) << "file [us]"
+              << std::setw( 12 ) << "MiB/s" << '\n';
+
+    for( const auto& result : results )
+    {
+        double runs = static_cast<double>( files.size() * iterations );
+
+        std::cout << std::left << std::setw( 16 ) << result.Backend << std::right << std::fixed << std::setprecision( 2 )
+                  << std::setw( 10 ) << files.size()
+                  << std::setw( 14 ) << bytes
+                  << std::setw( 12 ) << iterations
+                  << std::setw( 14 ) << result.Seconds * 1000
+                  << std::setw( 14 ) << ( runs > 0 ? result.Seconds * 1000000 / runs : 0 )
+                  << std::setw( 12 ) << ( result.Seconds > 0 ? static_cast<double>( bytes * iterations ) / ( 1024 * 1024 ) / result.Seconds : 0 ) << '\n';
+    }
+
+    if( counters )
+    {
+        using prs::counters::counter;
+
+        std::cout << '\n'
+                  << std::left << std::setw( 16 ) << "backend" << std::right;
+        for( size_t idx = 0; idx < prs::counters::Count; idx++ )
+            std::cout << std::setw( 18 ) << prs::counters::Name( static_cast<counter>( idx ) ) + "/byte";
+        std::cout << std::setw( 8 ) << "ipc" << '\n';
+
+        for( const auto& result : results )
+        {
+            double measured = static_cast<double>( bytes * iterations );
+            double cycles   = static_cast<double>( result.Counters.Get( counter::Cycles ) );
+
+            std::cout << std::left << std::setw( 16 ) << result.Backend << std::right << std::fixed << std::setprecision( 2 );
+            for( size_t idx = 0; idx < prs::counters::Count; idx++ )
+            {
+                counter which = static_cast<counter>( idx );
+
+                if( counters->IsAvailable( which ) && measured > 0 )
+                    std::cout << std::setw( 18 ) << static_cast<double>( result.Counters.Get( which ) ) / measured;
+                else
+                    std::cout << std::setw( 18 ) << "n/a";
+            }
+
+            if( counters->IsAvailable( counter::Cycles ) && counters->IsAvailable( counter::Instructions ) && cycles > 0 )
+                std::cout << std::setw( 8 ) << static_cast<double>( result.Counters.Get( counter::Instructions ) ) / cycles << '\n';
+            else
+                std::cout << std::setw( 8 ) << "n/a" << '\n';
+        }
+    }
+
+    // backends must agree on every file
+    bool same = true;
+    for( size_t idx = 1; idx < results.size(); idx++ )
+    {
+        for( size_t file = 0; file < files.size(); file++ )
+        {
+            if( results[idx].Verdicts[file] == results.front().Verdicts[file] )
+                continue;
+
+            prs::executable::Error( "Verdict mismatch <" + files[file] + "> " + results.front().Backend + "=" + ( results.front().Verdicts[file] ? "pass" : "fail" ) + " " + results[idx].Backend + "=" + ( results[idx].Verdicts[file] ? "pass" : "fail" ) );
+            same = false;
+        }
+    }
+
+    return same ? EXIT_SUCCESS : EXIT_FAILURE;
+}
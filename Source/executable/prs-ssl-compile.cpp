@@ -0,0 +1,207 @@
+#include <atomic>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "executable.hpp"
+#include "prs.compiler.hpp"
+#include "prs.hpp"
+#include "prs.parallel.hpp"
+#include "prs.ssl.hpp"
+
+// SSL compiler
+//
+// each file is parsed and compiled to .int file written next to it, or into --output directory;
+// files of a batch are compiled in parallel, one lib instance per worker
+//
+// --golden compares output with .int file next to source, nothing is written; missing reference file is an error
+
+namespace
+{
+    using ssl_lib = prs::lib<prs::ssl::Lexer, prs::ssl::Parser>;
+
+    const std::string OptionOutput  = "output";
+    const std::string OptionGolden  = "golden";
+    const std::string OptionThreads = "threads";
+
+    enum class status
+    {
+        Compiled,
+        NotLoaded,
+        NotParsed,
+        NotCompiled,
+        NotWritten,
+        GoldenMissing,
+        GoldenDifferent
+    };
+
+    struct outcome
+    {
+        status                                 Status      = status::NotLoaded;
+        std::string                            Output      = {};
+        std::vector<prs::parallel::diagnostic> Syntax      = {};
+        std::vector<prs::analysis::diagnostic> Diagnostics = {};
+    };
+
+    std::string OutputName( const std::string& filename, const std::string& directory )
+    {
+        std::filesystem::path result = std::filesystem::path( filename ).replace_extension( ".int" );
+
+        if( !directory.empty() )
+            result = std::filesystem::path( directory ) / result.filename();
+
+        return result.string();
+    }
+
+    bool Write( const std::string& filename, const std::vector<uint8_t>& bytes )
+    {
+        std::ofstream stream( filename, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc );
+        stream.write( reinterpret_cast<const char*>( bytes.data() ), static_cast<std::streamsize>( bytes.size() ) );
+
+        return static_cast<bool>( stream );
+    }
+
+    status Golden( const std::string& filename, const std::vector<uint8_t>& bytes )
+    {
+        std::ifstream stream( filename, std::ios_base::in | std::ios_base::binary );
+        if( !stream )
+            return status::GoldenMissing;
+
+        std::vector<uint8_t> expected( ( std::istreambuf_iterator<char>( stream ) ), std::istreambuf_iterator<char>() );
+
+        return expected == bytes ? status::Compiled : status::GoldenDifferent;
+    }
+}  // namespace
+
+int main( int argc, char** argv )
+{
+    prs::executable::Init( argc, argv, "SSL compiler" );
+    {
+        prs::executable::options::AddFile();
+        prs::executable::options::AddBatch();
+
+        auto option = prs::executable::options::Get().add_options( "Compile" );
+        option( OptionOutput, "Output directory (default: next to source file)", cxxopts::value<std::string>() );
+        option( OptionGolden, "Compare output with .int file next to source file, instead of writing it" );
+        option( OptionThreads, "Number of threads (0 = all cores)", cxxopts::value<size_t>()->default_value( "0" ) );
+    }
+
+    auto&                    parsed    = prs::executable::options::GetParsed();
+    std::vector<std::string> files     = prs::executable::options::Files( "ssl" );
+    std::string              directory = parsed.count( OptionOutput ) ? parsed[OptionOutput].as<std::string>() : std::string();
+    bool                     golden    = parsed.count( OptionGolden ) > 0;
+
+    if( golden && !directory.empty() )
+    {
+        prs::executable::Error( "Options <" + OptionOutput + "> and <" + OptionGolden + "> cannot be used together" );
+        return EXIT_FAILURE;
+    }
+    else if( !directory.empty() && !std::filesystem::is_directory( directory ) )
+    {
+        prs::executable::Error( "Output directory does not exist <" + directory + ">" );
+        return EXIT_FAILURE;
+    }
+
+    std::vector<outcome> outcomes( files.size() );
+    std::atomic<size_t>  nextFile = 0;
+
+    prs::parallel::Pool( prs::parallel::Threads( parsed[OptionThreads].as<size_t>(), files.size() ), [&]() {
+        ssl_lib                  ssl;
+        prs::parallel::collector errors;
+
+        ssl.GetLexer()->removeErrorListeners();
+        ssl.GetLexer()->addErrorListener( &errors );
+        ssl.GetParser()->removeErrorListeners();
+        ssl.GetParser()->addErrorListener( &errors );
+
+        for( size_t idx = nextFile++; idx < files.size(); idx = nextFile++ )
+        {
+            outcome& current = outcomes[idx];
+
+            errors.Clear();
+            if( !ssl.LoadFile( files[idx] ) )
+                continue;
+
+            // syntax errors leaves tree with tokens created by error recovery, it must not reach code generation
+            bool success   = ssl.ParseAdaptive();
+            current.Syntax = std::move( errors.Get() );
+            if( !success || !current.Syntax.empty() )
+            {
+                current.Status = status::NotParsed;
+                continue;
+            }
+
+            prs::compiler::result compiled = prs::compiler::Compile( ssl.GetLastParseTree() );
+            current.Diagnostics            = std::move( compiled.Diagnostics );
+            current.Output                 = OutputName( files[idx], directory );
+
+            if( !compiled.Success )
+                current.Status = status::NotCompiled;
+            else if( golden )
+                current.Status = Golden( current.Output, compiled.Bytes );
+            else
+                current.Status = Write( current.Output, compiled.Bytes ) ? status::Compiled : status::NotWritten;
+        }
+
+        ssl.UnloadFile();
+        ssl.GetLexer()->removeErrorListener( &errors );
+        ssl.GetParser()->removeErrorListener( &errors );
+    } );
+
+    bool   result   = true;
+    size_t compiled = 0;
+    for( size_t idx = 0; idx < files.size(); idx++ )
+    {
+        const outcome& current = outcomes[idx];
+
+        // same format as antlr4::ConsoleErrorListener
+        for( const auto& error : current.Syntax )
+            std::cerr << "line " << error.Line << ":" << error.Column << " " << error.Message << std::endl;
+
+        for( const auto& diagnostic : current.Diagnostics )
+        {
+            std::string message = files[idx] + ":" + std::to_string( diagnostic.Line ) + ":" + std::to_string( diagnostic.Column ) + " " + diagnostic.Message + " [" + diagnostic.Check + "]";
+
+            if( diagnostic.Severity == prs::analysis::severity::Error )
+                prs::executable::Error( message );
+            else
+                prs::executable::Warning( message );
+        }
+
+        switch( current.Status )
+        {
+            case status::Compiled:
+                compiled++;
+                break;
+            case status::NotLoaded:
+                prs::executable::Error( "File cannot be loaded <" + files[idx] + ">" );
+                break;
+            case status::NotParsed:
+                prs::executable::Error( "File cannot be parsed <" + files[idx] + ">" );
+                break;
+            case status::NotCompiled:
+                prs::executable::Error( "File cannot be compiled <" + files[idx] + ">" );
+                break;
+            case status::NotWritten:
+                prs::executable::Error( "File cannot be written <" + current.Output + ">" );
+                break;
+            case status::GoldenMissing:
+                prs::executable::Error( "Golden file does not exist <" + current.Output + ">" );
+                break;
+            case status::GoldenDifferent:
+                prs::executable::Error( "Output differs from golden file <" + current.Output + ">" );
+                break;
+        }
+
+        if( current.Status != status::Compiled )
+            result = false;
+    }
+
+    prs::executable::Notice( "Compiled " + std::to_string( compiled ) + " of " + std::to_string( files.size() ) + " file(s)" );
+
+    return result ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,362 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "executable.hpp"
+#include "prs.hpp"
+#include "prs.memory.hpp"
+#include "prs.ssl.hpp"
+
+// fuzzer looking for inputs with highest parsing cost per input byte, rather than crashes
+//
+// standalone mode (default)
+//   mutates seeds (--file/--batch) with grammar-aware mutations, keeping population of most expensive inputs
+//   slowest inputs are saved as regression tests (.ssl + .TIMEOUT, and .WILL_FAIL if input is invalid)
+//
+// libFuzzer mode (PRS_LIBFUZZER, clang only)
+//   coverage-guided search is done by libFuzzer itself; use -report_slow_units=<seconds> to keep expensive inputs
+
+namespace
+{
+    using ssl_lib = prs::lib<prs::ssl::Lexer, prs::ssl::Parser>;
+
+    struct cost
+    {
+        bool   Result = false;
+        double Time   = 0;  // seconds
+        size_t Bytes  = 0;  // allocated
+    };
+
+    ssl_lib& GetLib()
+    {
+        static ssl_lib* ssl = []() {
+            auto* result = new ssl_lib();
+
+            // errors are expected, printing them would cost more than parsing
+            result->GetLexer()->removeErrorListeners();
+            result->GetParser()->removeErrorListeners();
+
+            return result;
+        }();
+
+        return *ssl;
+    }
+
+    cost Run( const std::string& content )
+    {
+        ssl_lib& ssl = GetLib();
+        cost     result;
+
+        prs::memory::stats start     = prs::memory::Get();
+        auto               timeStart = std::chrono::steady_clock::now();
+
+        // mutations work on bytes, so input might not be valid UTF-8; it's rejected by loader, and there's no parsing cost to measure
+        try
+        {
+            ssl.LoadBuffer( content, "fuzz" );
+            result.Result = ssl.ParseAdaptive();
+        }
+        catch( const antlr4::IllegalArgumentException& )
+        {
+            ssl.UnloadFile();
+
+            return {};
+        }
+
+        result.Time  = std::chrono::duration<double>( std::chrono::steady_clock::now() - timeStart ).count();
+        result.Bytes = prs::memory::Get().Bytes - start.Bytes;
+
+        ssl.UnloadFile();
+
+        return result;
+    }
+}  // namespace
+
+#if defined( PRS_LIBFUZZER )
+
+extern "C" int LLVMFuzzerTestOneInput( const uint8_t* data, size_t size )
+{
+    Run( std::string( reinterpret_cast<const char*>( data ), size ) );
+
+    return 0;
+}
+
+#else
+
+namespace
+{
+    const std::string OptionIterations = "iterations";
+    const std::string OptionMaxSize    = "max-size";
+    const std::string OptionObjective  = "objective";
+    const std::string OptionSave       = "save";
+    const std::string OptionSaveCount  = "save-count";
+    const std::string OptionSeed       = "seed";
+    const std::string OptionTimeout    = "timeout";
+
+    // fragments most likely to trigger expensive paths in lexer (unfinished comments) and parser (blanks, nesting)
+    const std::vector<std::string> Dictionary = {
+        "/*", "*/", "//", "begin", "end", "procedure", "variable", "import", "if", "then", "true", "false",
+        " ", "\t", "\n", "\r\n", ";", "(", ")", ":=", "=", "++", "name", "0" };
+
+    struct entry
+    {
+        std::string Content = {};
+        cost        Cost    = {};
+        double      Score   = 0;
+    };
+
+    class fuzzer
+    {
+    private:
+        std::mt19937_64    Random;
+        std::vector<entry> Population = {};
+        size_t             MaxSize;
+        bool               ObjectiveMemory;
+
+        static constexpr size_t PopulationSize = 32;
+
+    public:
+        fuzzer( uint64_t seed, size_t maxSize, bool objectiveMemory ) :
+            Random( seed ), MaxSize( maxSize ), ObjectiveMemory( objectiveMemory )
+        {}
+
+        // cost per input byte, so inputs cannot win just by growing
+        double Score( const std::string& content, const cost& spent )
+        {
+            double size = static_cast<double>( std::max<size_t>( content.size(), 1 ) );
+
+            return ( ObjectiveMemory ? static_cast<double>( spent.Bytes ) : spent.Time ) / size;
+        }
+
+        void Add( std::string content )
+        {
+            if( content.size() > MaxSize )
+                content.resize( MaxSize );
+
+            entry candidate;
+            candidate.Cost    = Run( content );
+            candidate.Score   = Score( content, candidate.Cost );
+            candidate.Content = std::move( content );
+
+            if( Population.size() < PopulationSize )
+                Population.push_back( std::move( candidate ) );
+            else if( candidate.Score > Population.back().Score )
+                Population.back() = std::move( candidate );
+            else
+                return;
+
+            std::sort( Population.begin(), Population.end(), []( const entry& left, const entry& right ) {
+                return left.Score > right.Score;
+            } );
+        }
+
+        void Step()
+        {
+            std::string content = Pick().Content;
+
+            size_t mutations = Number( 1, 4 );
+            for( size_t idx = 0; idx < mutations; idx++ )
+                Mutate( content );
+
+            Add( std::move( content ) );
+        }
+
+        // re-measures best entries, as single run is too noisy to be saved as budget
+        const std::vector<entry>& Finish( size_t count )
+        {
+            if( Population.size() > count )
+                Population.resize( count );
+
+            for( auto& best : Population )
+            {
+                for( size_t repeat = 0; repeat < 3; repeat++ )
+                    best.Cost.Time = std::min( best.Cost.Time, Run( best.Content ).Time );
+
+                best.Score = Score( best.Content, best.Cost );
+            }
+
+            return Population;
+        }
+
+        const entry& Best()
+        {
+            return Population.front();
+        }
+
+    private:
+        size_t Number( size_t min, size_t max )
+        {
+            return std::uniform_int_distribution<size_t>( min, max )( Random );
+        }
+
+        const entry& Pick()
+        {
+            // prefer more expensive entries
+            size_t idx = std::min( Number( 0, Population.size() - 1 ), Number( 0, Population.size() - 1 ) );
+
+            return Population[idx];
+        }
+
+        void Mutate( std::string& content )
+        {
+            size_t pos = content.empty() ? 0 : Number( 0, content.size() );
+
+            switch( Number( 0, 5 ) )
+            {
+                case 0:  // insert dictionary word
+                    content.insert( pos, Dictionary[Number( 0, Dictionary.size() - 1 )] );
+                    break;
+                case 1:  // repeat dictionary word, grows runs of blanks and nesting
+                {
+                    const std::string& word  = Dictionary[Number( 0, Dictionary.size() - 1 )];
+                    size_t             count = Number( 2, 64 );
+                    std::string        run;
+
+                    for( size_t idx = 0; idx < count; idx++ )
+                        run += word;
+
+                    content.insert( pos, run );
+                    break;
+                }
+                case 2:  // duplicate chunk
+                {
+                    if( content.empty() )
+                        break;
+
+                    size_t start = Number( 0, content.size() - 1 );
+                    size_t size  = Number( 1, std::min<size_t>( 64, content.size() - start ) );
+
+                    content.insert( pos, content.substr( start, size ) );
+                    break;
+                }
+                case 3:  // erase chunk
+                {
+                    if( content.empty() )
+                        break;
+
+                    size_t start = Number( 0, content.size() - 1 );
+                    content.erase( start, Number( 1, std::min<size_t>( 16, content.size() - start ) ) );
+                    break;
+                }
+                case 4:  // replace byte
+                    if( !content.empty() )
+                        content[Number( 0, content.size() - 1 )] = static_cast<char>( Number( 0, 255 ) );
+                    break;
+                case 5:  // splice with other entry
+                {
+                    const std::string& other = Pick().Content;
+                    if( !other.empty() )
+                        content.insert( pos, other.substr( Number( 0, other.size() - 1 ) ) );
+                    break;
+                }
+            }
+
+            if( content.size() > MaxSize )
+                content.resize( MaxSize );
+        }
+    };
+
+    void Save( const std::string& directory, size_t index, const entry& best, double timeoutMin )
+    {
+        std::filesystem::create_directories( directory );
+
+        std::string number = std::to_string( index );
+        if( number.size() < 3 )
+            number.insert( 0, 3 - number.size(), '0' );
+
+        std::string name = ( std::filesystem::path( directory ) / ( "slow." + number ) ).string();
+
+        std::ofstream( name + ".ssl", std::ios_base::binary ) << best.Content;
+
+        // same as Test/prs-ssl/Pathological, cost is measured without tokens/trace/tree output added by default command line
+        std::ofstream( name + ".COMMAND_LINE" ) << "--file=@filename@";
+
+        // generous budget, test should catch complexity regressions rather than slower machines
+        std::ofstream( name + ".TIMEOUT" ) << static_cast<size_t>( std::ceil( std::max( timeoutMin, best.Cost.Time * 100 ) ) );
+
+        if( !best.Cost.Result )
+            std::ofstream( name + ".WILL_FAIL" ) << 1;
+    }
+}  // namespace
+
+int main( int argc, char** argv )
+{
+    prs::executable::Init( argc, argv, "SSL parser fuzzer (parsing cost per byte)" );
+    {
+        prs::executable::options::AddFile();
+        prs::executable::options::AddBatch();
+
+        auto option = prs::executable::options::Get().add_options( "Fuzzer" );
+        option( OptionIterations, "Number of mutated inputs to parse", cxxopts::value<size_t>()->default_value( "10000" ) );
+        option( OptionMaxSize, "Maximum input size", cxxopts::value<size_t>()->default_value( "4096" ) );
+        option( OptionObjective, "Cost to maximize (time, memory)", cxxopts::value<std::string>()->default_value( "time" ) );
+        option( OptionSave, "Directory where slowest inputs are saved as tests", cxxopts::value<std::string>() );
+        option( OptionSaveCount, "Number of inputs to save", cxxopts::value<size_t>()->default_value( "5" ) );
+        option( OptionSeed, "Random seed", cxxopts::value<uint64_t>()->default_value( "0" ) );
+        option( OptionTimeout, "Minimal time budget of saved tests (seconds)", cxxopts::value<double>()->default_value( "5" ) );
+    }
+
+    auto&       parsed    = prs::executable::options::GetParsed();
+    std::string objective = parsed[OptionObjective].as<std::string>();
+
+    if( objective != "time" && objective != "memory" )
+    {
+        prs::executable::Error( "Unknown objective <" + objective + ">" );
+        return EXIT_FAILURE;
+    }
+    else if( objective == "memory" && !prs::memory::IsHooked() )
+    {
+        prs::executable::Error( "Memory objective requires executable built with PRS_MEMORY_HOOK" );
+        return EXIT_FAILURE;
+    }
+
+    fuzzer fuzz( parsed[OptionSeed].as<uint64_t>(), parsed[OptionMaxSize].as<size_t>(), objective == "memory" );
+
+    fuzz.Add( {} );
+    for( const auto& filename : prs::executable::options::Files( "ssl" ) )
+    {
+        std::string content;
+        if( !prs::LoadFile( filename, content ) )
+        {
+            prs::executable::Error( "File cannot be loaded <" + filename + ">" );
+            return EXIT_FAILURE;
+        }
+
+        fuzz.Add( std::move( content ) );
+    }
+
+    size_t iterations = parsed[OptionIterations].as<size_t>();
+    for( size_t iteration = 1; iteration <= iterations; iteration++ )
+    {
+        fuzz.Step();
+
+        if( iteration % 1000 == 0 || iteration == iterations )
+        {
+            const entry& best = fuzz.Best();
+            prs::executable::Notice( "iteration=" + std::to_string( iteration ) + " size=" + std::to_string( best.Content.size() ) + " time=" + std::to_string( best.Cost.Time * 1000 ) + "ms bytes=" + std::to_string( best.Cost.Bytes ) + " score=" + std::to_string( best.Score ) );
+        }
+    }
+
+    const auto& slowest = fuzz.Finish( parsed[OptionSaveCount].as<size_t>() );
+    if( parsed.count( OptionSave ) )
+    {
+        std::string directory = parsed[OptionSave].as<std::string>();
+        for( size_t idx = 0; idx < slowest.size(); idx++ )
+            Save( directory, idx + 1, slowest[idx], parsed[OptionTimeout].as<double>() );
+
+        prs::executable::Notice( "Saved " + std::to_string( slowest.size() ) + " input(s) <" + directory + ">" );
+    }
+
+    return EXIT_SUCCESS;
+}
+
+#endif
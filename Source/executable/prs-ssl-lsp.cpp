@@ -0,0 +1,582 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#if defined( _WIN32 )
+    #include <fcntl.h>
+    #include <io.h>
+#endif
+
+#include "executable.hpp"
+#include "prs.hpp"
+#include "prs.json.hpp"
+#include "prs.parallel.hpp"
+#include "prs.ssl.hpp"
+
+// language server, using stdio transport
+//
+// documents are kept in memory and updated with incremental changes sent by client
+// each document owns its own lib instance, so parser is never re-created between changes;
+// syntax errors are published after every change, document symbols are created from last parse tree
+//
+// everything is written to stdout is part of protocol, prs::executable::Notice() and friends must not be used after startup
+
+namespace
+{
+    using ssl_lib = prs::lib<prs::ssl::Lexer, prs::ssl::Parser>;
+    using json    = prs::json::value;
+
+    const std::string OptionReplay = "replay";
+    const std::string OptionLog    = "log";
+
+    // https://microsoft.github.io/language-server-protocol/specifications/lsp/3.17/specification/
+    namespace protocol
+    {
+        constexpr int ParseError           = -32700;
+        constexpr int InvalidRequest       = -32600;
+        constexpr int MethodNotFound       = -32601;
+        constexpr int ServerNotInitialized = -32002;
+
+        constexpr int TextDocumentSyncIncremental = 2;
+
+        constexpr int DiagnosticSeverityError = 1;
+
+        constexpr int MessageTypeLog = 4;
+
+        constexpr int SymbolKindFunction = 12;
+        constexpr int SymbolKindVariable = 13;
+    }  // namespace protocol
+
+    class document
+    {
+    private:
+        std::string                            Content     = {};
+        std::vector<size_t>                    LineStart   = { 0 };
+        std::unique_ptr<ssl_lib>               Lib         = std::make_unique<ssl_lib>();
+        prs::parallel::collector               Errors      = {};
+        std::vector<prs::parallel::diagnostic> Diagnostics = {};
+
+    public:
+        long long Version = 0;
+        double    Time    = 0;  // last parsing time, in seconds
+
+    public:
+        document()
+        {
+            Lib->GetLexer()->removeErrorListeners();
+            Lib->GetLexer()->addErrorListener( &Errors );
+            Lib->GetParser()->removeErrorListeners();
+            Lib->GetParser()->addErrorListener( &Errors );
+        }
+
+        document( const document& ) = delete;
+        document( document&& )      = delete;
+        ~document()                 = default;
+
+        document& operator=( const document& ) = delete;
+        document& operator=( document&& )      = delete;
+
+    public:
+        void Set( std::string content )
+        {
+            Content = std::move( content );
+            Lines();
+        }
+
+        // range is in protocol units (zero-based lines, UTF-16 characters)
+        void Change( const json& range, const std::string& text )
+        {
+            size_t start = Offset( range.Get( "start" ) );
+            size_t end   = std::max( start, Offset( range.Get( "end" ) ) );
+
+            Content.replace( start, end - start, text );
+            Lines();
+        }
+
+        void Parse()
+        {
+            auto start = std::chrono::steady_clock::now();
+
+            // parser listeners are detached by ParseAdaptive() during SLL stage, so only errors found by LL stage are collected
+            Errors.Clear();
+            try
+            {
+                Lib->LoadContent( Content, "document" );
+                Lib->ParseAdaptive();
+                Diagnostics = std::move( Errors.Get() );
+            }
+            // content which cannot be decoded (lone surrogate sent by client, etc.) is reported at start of document
+            catch( const std::exception& exception )
+            {
+                Lib->UnloadFile();
+                Diagnostics = { { 1, 0, exception.what() } };
+            }
+
+            Time = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+        }
+
+        json GetDiagnostics() const
+        {
+            json result = prs::json::array();
+
+            for( const auto& error : Diagnostics )
+            {
+                size_t start = Offset( error.Line, error.Column );
+
+                json diagnostic;
+                diagnostic["range"]["start"] = Position( start );
+                diagnostic["range"]["end"]   = Position( Next( start ) );
+                diagnostic["severity"]       = protocol::DiagnosticSeverityError;
+                diagnostic["source"]         = "prs";
+                diagnostic["message"]        = error.Message;
+
+                result.Push( std::move( diagnostic ) );
+            }
+
+            return result;
+        }
+
+        json GetSymbols() const
+        {
+            json result = prs::json::array();
+
+            if( Lib->GetLastParseTree() )
+                Symbols( Lib->GetLastParseTree(), result );
+
+            return result;
+        }
+
+    private:
+        void Lines()
+        {
+            LineStart.assign( 1, 0 );
+            for( size_t pos = Content.find( '\n' ); pos != std::string::npos; pos = Content.find( '\n', pos + 1 ) )
+                LineStart.push_back( pos + 1 );
+        }
+
+        static bool IsContinuation( char c )
+        {
+            return ( static_cast<unsigned char>( c ) & 0xC0 ) == 0x80;
+        }
+
+        // returns offset of next code point
+        size_t Next( size_t offset ) const
+        {
+            if( offset >= Content.size() || Content[offset] == '\n' )
+                return offset;
+
+            for( offset++; offset < Content.size() && IsContinuation( Content[offset] ); offset++ )
+                ;
+
+            return offset;
+        }
+
+        size_t LineEnd( size_t line ) const
+        {
+            return line + 1 < LineStart.size() ? LineStart[line + 1] - 1 : Content.size();
+        }
+
+        // protocol position -> offset
+        size_t Offset( const json& position ) const
+        {
+            size_t line      = static_cast<size_t>( std::max( position.Get( "line" ).GetNumber(), 0.0 ) );
+            size_t character = static_cast<size_t>( std::max( position.Get( "character" ).GetNumber(), 0.0 ) );
+
+            if( line >= LineStart.size() )
+                return Content.size();
+
+            size_t offset = LineStart[line];
+            size_t end    = LineEnd( line );
+            for( size_t units = 0; units < character && offset < end; )
+            {
+                // code points outside BMP are encoded with 4 bytes in UTF-8, and surrogate pair in UTF-16
+                units += static_cast<unsigned char>( Content[offset] ) >= 0xF0 ? 2 : 1;
+                offset = Next( offset );
+            }
+
+            return offset;
+        }
+
+        // antlr position (one-based line, code points) -> offset
+        size_t Offset( size_t line, size_t column ) const
+        {
+            if( line == 0 || line > LineStart.size() )
+                return Content.size();
+
+            size_t offset = LineStart[line - 1];
+            size_t end    = LineEnd( line - 1 );
+            for( size_t idx = 0; idx < column && offset < end; idx++ )
+                offset = Next( offset );
+
+            return offset;
+        }
+
+        // offset -> protocol position
+        json Position( size_t offset ) const
+        {
+            offset      = std::min( offset, Content.size() );
+            size_t line = static_cast<size_t>( std::upper_bound( LineStart.begin(), LineStart.end(), offset ) - LineStart.begin() ) - 1;
+
+            size_t units = 0;
+            for( size_t pos = LineStart[line]; pos < offset; pos = Next( pos ) )
+                units += static_cast<unsigned char>( Content[pos] ) >= 0xF0 ? 2 : 1;
+
+            json result;
+            result["line"]      = line;
+            result["character"] = units;
+
+            return result;
+        }
+
+        json Range( const antlr4::Token* start, const antlr4::Token* stop ) const
+        {
+            if( !stop || stop->getType() == antlr4::Token::EOF || stop->getTokenIndex() < start->getTokenIndex() )
+                stop = start;
+
+            json result;
+            result["start"] = Position( Offset( start->getLine(), start->getCharPositionInLine() ) );
+            result["end"]   = Position( Offset( stop->getLine(), stop->getCharPositionInLine() ) + stop->getText().size() );
+
+            return result;
+        }
+
+        // tokens created by error recovery are not part of input
+        static bool IsReal( const antlr4::Token* token )
+        {
+            return token && token->getTokenIndex() != antlr4::INVALID_INDEX;
+        }
+
+        template<typename ContextType>
+        static ContextType* Find( antlr4::tree::ParseTree* tree )
+        {
+            if( auto* context = dynamic_cast<ContextType*>( tree ) )
+                return context;
+
+            for( auto* child : tree->children )
+            {
+                if( auto* context = Find<ContextType>( child ) )
+                    return context;
+            }
+
+            return nullptr;
+        }
+
+        json Symbol( antlr4::ParserRuleContext* context, antlr4::Token* name, int kind, const std::string& detail ) const
+        {
+            json result;
+            result["name"] = name->getText();
+            if( !detail.empty() )
+                result["detail"] = detail;
+            result["kind"]           = kind;
+            result["range"]          = Range( context->getStart(), context->getStop() );
+            result["selectionRange"] = Range( name, name );
+
+            return result;
+        }
+
+        // forward declarations are skipped, as they would duplicate procedures
+        void Symbols( antlr4::tree::ParseTree* tree, json& result ) const
+        {
+            for( auto* child : tree->children )
+            {
+                if( auto* body = dynamic_cast<prs::ssl::Parser::ProcedureBodyContext*>( child ) )
+                {
+                    auto* head = Find<prs::ssl::Parser::ProcedureHeadContext>( body );
+                    if( !head || !IsReal( head->name ) || !IsReal( body->getStart() ) )
+                        continue;
+
+                    json symbol        = Symbol( body, head->name, protocol::SymbolKindFunction, {} );
+                    symbol["children"] = prs::json::array();
+                    Symbols( body, symbol["children"] );
+
+                    result.Push( std::move( symbol ) );
+                }
+                else if( auto* procedure = dynamic_cast<prs::ssl::Parser::ProcedureImportContext*>( child ) )
+                {
+                    auto* head = Find<prs::ssl::Parser::ProcedureHeadContext>( procedure );
+                    if( head && IsReal( head->name ) && IsReal( procedure->getStart() ) )
+                        result.Push( Symbol( procedure, head->name, protocol::SymbolKindFunction, "import" ) );
+                }
+                else if( auto* variable = dynamic_cast<prs::ssl::Parser::VariableImportContext*>( child ) )
+                {
+                    auto* head = Find<prs::ssl::Parser::VariableHeadContext>( variable );
+                    if( head && IsReal( head->name ) && IsReal( variable->getStart() ) )
+                        result.Push( Symbol( variable, head->name, protocol::SymbolKindVariable, "import" ) );
+                }
+                else if( auto* declaration = dynamic_cast<prs::ssl::Parser::VariableDeclarationContext*>( child ) )
+                {
+                    auto* head = Find<prs::ssl::Parser::VariableHeadContext>( declaration );
+                    if( head && IsReal( head->name ) && IsReal( declaration->getStart() ) )
+                        result.Push( Symbol( declaration, head->name, protocol::SymbolKindVariable, {} ) );
+                }
+                else if( !dynamic_cast<prs::ssl::Parser::ProcedureDeclarationContext*>( child ) )
+                    Symbols( child, result );
+            }
+        }
+    };
+
+    class server
+    {
+    private:
+        std::istream&                                    In;
+        std::ostream&                                    Out;
+        std::map<std::string, std::unique_ptr<document>> Documents = {};
+
+        bool Log         = false;
+        bool Initialized = false;
+        bool Shutdown    = false;
+
+    public:
+        server( std::istream& in, std::ostream& out, bool log ) :
+            In( in ), Out( out ), Log( log )
+        {}
+
+        // returns process exit code
+        int Run()
+        {
+            std::string content;
+            while( Read( content ) )
+            {
+                json message;
+                if( !prs::json::Parse( content, message ) || !message.IsObject() )
+                {
+                    Reply( nullptr, {}, protocol::ParseError, "Invalid JSON" );
+                    continue;
+                }
+
+                // exit code is 1 if client did not request shutdown first
+                if( message.Get( "method" ).GetString() == "exit" )
+                    return Shutdown ? EXIT_SUCCESS : EXIT_FAILURE;
+
+                Handle( message );
+            }
+
+            // stream closed without exit notification
+            return EXIT_FAILURE;
+        }
+
+    private:
+        bool Read( std::string& content )
+        {
+            size_t      length = 0;
+            bool        found  = false;
+            std::string line;
+
+            while( std::getline( In, line ) )
+            {
+                if( !line.empty() && line.back() == '\r' )
+                    line.pop_back();
+
+                if( line.empty() )
+                    break;
+
+                constexpr std::string_view header = "Content-Length:";
+                if( line.compare( 0, header.size(), header ) == 0 )
+                {
+                    length = std::strtoull( line.c_str() + header.size(), nullptr, 10 );
+                    found  = true;
+                }
+            }
+
+            if( !In || !found )
+                return false;
+
+            content.resize( length );
+            In.read( content.data(), static_cast<std::streamsize>( length ) );
+
+            return static_cast<size_t>( In.gcount() ) == length;
+        }
+
+        void Write( const json& message )
+        {
+            std::string content = prs::json::Dump( message );
+
+            Out << "Content-Length: " << content.size() << "\r\n\r\n"
+                << content;
+            Out.flush();
+        }
+
+        void Reply( const json& id, json result, int error = 0, const std::string& message = {} )
+        {
+            json response;
+            response["jsonrpc"] = "2.0";
+            response["id"]      = id;
+
+            if( error )
+            {
+                response["error"]["code"]    = error;
+                response["error"]["message"] = message;
+            }
+            else
+                response["result"] = std::move( result );
+
+            Write( response );
+        }
+
+        void Notify( const std::string& method, json params )
+        {
+            json notification;
+            notification["jsonrpc"] = "2.0";
+            notification["method"]  = method;
+            notification["params"]  = std::move( params );
+
+            Write( notification );
+        }
+
+        void Publish( const std::string& uri, const document* doc )
+        {
+            json params;
+            params["uri"] = uri;
+            if( doc )
+            {
+                params["version"]     = doc->Version;
+                params["diagnostics"] = doc->GetDiagnostics();
+
+                if( Log )
+                {
+                    json log;
+                    log["type"]    = protocol::MessageTypeLog;
+                    log["message"] = "Parsed " + uri + " in " + std::to_string( doc->Time * 1000 ) + "ms";
+
+                    Notify( "window/logMessage", std::move( log ) );
+                }
+            }
+            else
+                params["diagnostics"] = prs::json::array();
+
+            Notify( "textDocument/publishDiagnostics", std::move( params ) );
+        }
+
+        void Handle( const json& message )
+        {
+            const std::string& method  = message.Get( "method" ).GetString();
+            const json&        id      = message.Get( "id" );
+            const json&        params  = message.Get( "params" );
+            const std::string& uri     = params.Get( "textDocument" ).Get( "uri" ).GetString();
+            bool               request = message.Find( "id" ) != nullptr;
+
+            // responses to server requests are not expected
+            if( method.empty() )
+                return;
+
+            // requests sent as notifications are ignored, there's no way to answer them
+            if( !request && ( method == "initialize" || method == "shutdown" || method == "textDocument/documentSymbol" ) )
+                return;
+
+            if( method == "initialize" )
+            {
+                json result;
+                result["capabilities"]["textDocumentSync"]["openClose"] = true;
+                result["capabilities"]["textDocumentSync"]["change"]    = protocol::TextDocumentSyncIncremental;
+                result["capabilities"]["documentSymbolProvider"]        = true;
+                result["serverInfo"]["name"]                            = "prs-ssl-lsp";
+
+                Initialized = true;
+                Reply( id, std::move( result ) );
+            }
+            else if( !Initialized )
+            {
+                if( request )
+                    Reply( id, {}, protocol::ServerNotInitialized, "Server not initialized" );
+            }
+            else if( Shutdown )
+            {
+                if( request )
+                    Reply( id, {}, protocol::InvalidRequest, "Server is shutting down" );
+            }
+            else if( method == "shutdown" )
+            {
+                Shutdown = true;
+                Documents.clear();
+                Reply( id, nullptr );
+            }
+            else if( method == "textDocument/didOpen" )
+            {
+                auto& doc = Documents[uri];
+                doc       = std::make_unique<document>();
+
+                doc->Version = static_cast<long long>( params.Get( "textDocument" ).Get( "version" ).GetNumber() );
+                doc->Set( params.Get( "textDocument" ).Get( "text" ).GetString() );
+                doc->Parse();
+
+                Publish( uri, doc.get() );
+            }
+            else if( method == "textDocument/didChange" )
+            {
+                auto it = Documents.find( uri );
+                if( it == Documents.end() )
+                    return;
+
+                document& doc = *it->second;
+                for( const auto& change : params.Get( "contentChanges" ).GetArray() )
+                {
+                    if( const json* range = change.Find( "range" ) )
+                        doc.Change( *range, change.Get( "text" ).GetString() );
+                    else
+                        doc.Set( change.Get( "text" ).GetString() );
+                }
+
+                doc.Version = static_cast<long long>( params.Get( "textDocument" ).Get( "version" ).GetNumber() );
+                doc.Parse();
+
+                Publish( uri, &doc );
+            }
+            else if( method == "textDocument/didClose" )
+            {
+                Documents.erase( uri );
+                Publish( uri, nullptr );
+            }
+            else if( method == "textDocument/documentSymbol" )
+            {
+                auto it = Documents.find( uri );
+
+                Reply( id, it != Documents.end() ? it->second->GetSymbols() : json() );
+            }
+            else if( request )
+                Reply( id, {}, protocol::MethodNotFound, "Method not found <" + method + ">" );
+        }
+    };
+}  // namespace
+
+int main( int argc, char** argv )
+{
+    prs::executable::Init( argc, argv, "SSL language server (stdio)" );
+    {
+        auto option = prs::executable::options::Get().add_options( "Server" );
+        option( OptionReplay, "Read client messages from file instead of stdin", cxxopts::value<std::string>() );
+        option( OptionLog, "Send parsing time to client after each change" );
+    }
+
+    auto& parsed = prs::executable::options::GetParsed();
+
+#if defined( _WIN32 )
+    // protocol headers use \r\n, which must not be translated
+    _setmode( _fileno( stdin ), _O_BINARY );
+    _setmode( _fileno( stdout ), _O_BINARY );
+#endif
+
+    std::ifstream replay;
+    if( parsed.count( OptionReplay ) )
+    {
+        replay.open( parsed[OptionReplay].as<std::string>(), std::ios_base::in | std::ios_base::binary );
+        if( !replay )
+        {
+            prs::executable::Error( "File cannot be loaded <" + parsed[OptionReplay].as<std::string>() + ">" );
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::ios_base::sync_with_stdio( false );
+
+    server lsp( replay.is_open() ? replay : std::cin, std::cout, parsed.count( OptionLog ) > 0 );
+
+    return lsp.Run();
+}
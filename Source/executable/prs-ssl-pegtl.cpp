@@ -0,0 +1,37 @@
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "executable.hpp"
+#include "prs.pegtl.ssl.hpp"
+
+int main( int argc, char** argv )
+{
+    prs::executable::Init( argc, argv, "SSL parser (PEGTL)" );
+    {
+        prs::executable::options::AddFile();
+        prs::executable::options::AddGroupDiagnostics();
+    }
+
+    prs::pegtl::ssl::lib ssl;
+
+    std::string filename = prs::executable::options::File();
+    if( !ssl.LoadFile( filename ) )
+    {
+        prs::executable::Error( "File cannot be loaded <" + filename + ">" );
+        return EXIT_FAILURE;
+    }
+
+    ssl.SetTrace( prs::executable::options::IsTrace() );
+
+    if( prs::executable::options::IsTokens() )
+        ssl.PrintTokens( prs::executable::options::IsTokensFull() );
+
+    bool result = ssl.ParseAdaptive();
+    ssl.PrintErrors();
+
+    if( prs::executable::options::IsTree() && ssl.GetLastParseTree() )
+        std::cout << ssl.GetTreeString() << std::endl;
+
+    return result ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,348 @@
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "executable.hpp"
+#include "prs.analysis.hpp"
+#include "prs.hpp"
+#include "prs.parallel.hpp"
+#include "prs.ssl.hpp"
+
+// In-process test driver
+//
+// runs test cases laid out for CMake/CTestRunner.cmake in single process, on thread pool, one lib instance per worker
+// case configuration files:
+//   .DISABLED            case is skipped
+//   .WILL_FAIL           case passes only if it fails
+//   .TIMEOUT             parsing time limit (seconds)
+//   .COMMAND_LINE        replaces default command line, .COMMAND_LINE_BEFORE/.COMMAND_LINE_AFTER are added to it otherwise
+//   .TREE                (optional) golden parse tree, as returned by prs::base::GetTreeString() (with rule names, unlike --tree output) followed by newline
+//   .PASS_REGULAR_EXPRESSION, .FAIL_REGULAR_EXPRESSION
+//                        case checks program output, and is skipped
+//
+// command line options (--timeout, --error-limit, --check, --parallel) are mapped to in-process equivalents; diagnostics options only changes output, and are ignored,
+// cases using options which needs own process (--batch, --profile, --memstats, ...) are skipped
+
+namespace
+{
+    using ssl_lib = prs::lib<prs::ssl::Lexer, prs::ssl::Parser>;
+
+    const std::string OptionCommandLine = "command-line";
+    const std::string OptionThreads     = "threads";
+
+    enum class status
+    {
+        Passed,
+        Failed,
+        Skipped
+    };
+
+    struct test_case
+    {
+        std::string File    = {};
+        std::string Reason  = {};  // why case failed or was skipped
+        status      Status  = status::Passed;
+        double      Seconds = 0;
+
+        // configuration
+        bool        Disabled      = false;
+        bool        WillFail      = false;
+        bool        Invalid       = false;  // options would be rejected by prs-ssl
+        double      Timeout       = 0;
+        bool        Check         = false;
+        bool        Parallel      = false;
+        size_t      ParallelChunk = 65536;
+        size_t      ErrorLimit    = 0;
+        size_t      DepthLimit    = 0;
+        std::string Golden        = {};
+        bool        HasGolden     = false;
+    };
+
+    bool Sidecar( const std::string& file, const std::string& extension, std::string& content )
+    {
+        std::string filename = std::filesystem::path( file ).replace_extension( "." + extension ).string();
+
+        return std::filesystem::is_regular_file( filename ) && prs::LoadFile( filename, content );
+    }
+
+    // same rules as CMake if()
+    bool IsTrue( std::string text )
+    {
+        text.erase( text.find_last_not_of( " \t\r\n" ) + 1 );
+        std::transform( text.begin(), text.end(), text.begin(), []( unsigned char ch ) { return static_cast<char>( std::toupper( ch ) ); } );
+
+        return !text.empty() && text != "0" && text != "OFF" && text != "NO" && text != "FALSE" && text != "N" && text != "IGNORE" && text != "NOTFOUND" && !text.ends_with( "-NOTFOUND" );
+    }
+
+    bool Number( const std::string& text, double& value )
+    {
+        std::istringstream stream( text );
+
+        return static_cast<bool>( stream >> value ) && stream.eof();
+    }
+
+    // returns false if case must be skipped
+    bool Configure( test_case& current, const std::string& defaultCommandLine )
+    {
+        std::string content;
+
+        current.Disabled  = Sidecar( current.File, "DISABLED", content ) && IsTrue( content );
+        current.WillFail  = Sidecar( current.File, "WILL_FAIL", content ) && IsTrue( content );
+        current.HasGolden = Sidecar( current.File, "TREE", current.Golden );
+
+        if( Sidecar( current.File, "PASS_REGULAR_EXPRESSION", content ) || Sidecar( current.File, "FAIL_REGULAR_EXPRESSION", content ) )
+        {
+            current.Reason = "Output check requires own process";
+            return false;
+        }
+
+        if( Sidecar( current.File, "TIMEOUT", content ) && !Number( content, current.Timeout ) )
+        {
+            current.Reason = "Invalid TIMEOUT file";
+            return false;
+        }
+
+        std::string commandLine;
+        if( Sidecar( current.File, "COMMAND_LINE", content ) )
+            commandLine = content;
+        else
+        {
+            commandLine = defaultCommandLine;
+            if( Sidecar( current.File, "COMMAND_LINE_BEFORE", content ) )
+                commandLine = content + " " + commandLine;
+            if( Sidecar( current.File, "COMMAND_LINE_AFTER", content ) )
+                commandLine += " " + content;
+        }
+
+        std::istringstream stream( commandLine );
+        std::string        argument;
+        while( stream >> argument )
+        {
+            size_t      separator = argument.find( '=' );
+            std::string name      = argument.substr( 0, separator );
+            std::string value     = separator == std::string::npos ? std::string() : argument.substr( separator + 1 );
+            double      number    = 0;
+
+            if( name == "--file" )
+            {
+                if( value != "@filename@" )
+                {
+                    current.Reason = "Option <" + argument + "> must use @filename@";
+                    return false;
+                }
+            }
+            else if( name == "--tokens" || name == "--tokens-full" || name == "--trace" || name == "--tree" )
+                continue;
+            else if( name == "--timeout" )
+            {
+                if( !Number( value, number ) || number <= 0 )
+                    current.Invalid = true;
+                else
+                    current.Timeout = number;
+            }
+            else if( name == "--check" )
+                current.Check = true;
+            else if( name == "--parallel" )
+                current.Parallel = true;
+            else if( name == "--error-limit" )
+            {
+                if( value.empty() )
+                    current.ErrorLimit = 1;
+                else if( !Number( value, number ) || number < 0 )
+                    current.Invalid = true;
+                else
+                    current.ErrorLimit = static_cast<size_t>( number );
+            }
+            else if( name == "--depth-limit" )
+            {
+                if( value.empty() )
+                    current.DepthLimit = 2000;
+                else if( !Number( value, number ) || number < 0 )
+                    current.Invalid = true;
+                else
+                    current.DepthLimit = static_cast<size_t>( number );
+            }
+            else if( name == "--parallel-chunk" )
+            {
+                if( !Number( value, number ) || number < 0 )
+                    current.Invalid = true;
+                else
+                    current.ParallelChunk = static_cast<size_t>( number );
+            }
+            else
+            {
+                current.Reason = "Option <" + name + "> requires own process";
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    // returns true if case was processed without errors
+    bool Run( test_case& current, ssl_lib& ssl, const prs::analysis::analyzer& analyzer )
+    {
+        if( current.Invalid )
+        {
+            current.Reason = "Invalid options";
+            return false;
+        }
+
+        std::unique_ptr<prs::deadline> until;
+        if( current.Timeout > 0 )
+            until = std::make_unique<prs::deadline>( std::chrono::duration_cast<prs::deadline::clock::duration>( std::chrono::duration<double>( current.Timeout ) ) );
+
+        if( current.Parallel )
+        {
+            std::string content;
+            if( !prs::LoadFile( current.File, content ) )
+            {
+                current.Reason = "File cannot be loaded";
+                return false;
+            }
+
+            prs::parallel::result result = prs::parallel::Parse( content, []() { return std::make_unique<ssl_lib>(); }, current.ParallelChunk, 1, until.get() );
+            if( !result.Success )
+                current.Reason = result.TimedOut ? "Parsing timed out" : "Parsing failed";
+
+            return result.Success;
+        }
+
+        ssl.CollectErrors( current.ErrorLimit );
+        ssl.SetDepthLimit( current.DepthLimit );
+        if( !ssl.LoadFile( current.File ) )
+        {
+            current.Reason = "File cannot be loaded";
+            return false;
+        }
+
+        if( !ssl.ParseAdaptive( until.get() ) )
+        {
+            current.Reason = ssl.IsTimedOut() ? "Parsing timed out" : ssl.IsErrorLimitReached() ? "Error limit reached" : ssl.IsDepthLimitReached() ? "Nesting limit reached" : "Parsing failed";
+            return false;
+        }
+
+        if( current.HasGolden && ssl.GetTreeString() + "\n" != current.Golden )
+        {
+            current.Reason = "Parse tree differs from golden file";
+            return false;
+        }
+
+        if( current.Check )
+        {
+            for( const auto& diagnostic : analyzer.Run( prs::analysis::table::Build( ssl.GetLastParseTree() ), 1 ) )
+            {
+                if( diagnostic.Severity == prs::analysis::severity::Error )
+                {
+                    current.Reason = "Semantic check failed [" + diagnostic.Check + "]";
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
+}  // namespace
+
+int main( int argc, char** argv )
+{
+    prs::executable::Init( argc, argv, "SSL test driver" );
+    {
+        prs::executable::options::AddFile();
+        prs::executable::options::AddBatch();
+
+        auto option = prs::executable::options::Get().add_options( "Test" );
+        option( OptionCommandLine, "Default command line, used if case has no COMMAND_LINE file", cxxopts::value<std::string>()->default_value( "--file=@filename@ --tokens --trace --tree" ) );
+        option( OptionThreads, "Number of threads (0 = all cores)", cxxopts::value<size_t>()->default_value( "0" ) );
+    }
+
+    auto&                    parsed      = prs::executable::options::GetParsed();
+    std::vector<std::string> files       = prs::executable::options::Files( "ssl" );
+    std::string              commandLine = parsed[OptionCommandLine].as<std::string>();
+
+    std::vector<test_case> cases( files.size() );
+    std::atomic<size_t>    nextCase = 0;
+
+    prs::parallel::Pool( prs::parallel::Threads( parsed[OptionThreads].as<size_t>(), files.size() ), [&]() {
+        ssl_lib                 ssl;
+        prs::analysis::analyzer analyzer;
+
+        // errors are part of expected results, they're not printed
+        ssl.CollectErrors();
+
+        for( size_t idx = nextCase++; idx < files.size(); idx = nextCase++ )
+        {
+            test_case& current = cases[idx];
+            current.File       = files[idx];
+
+            if( !Configure( current, commandLine ) || current.Disabled )
+            {
+                if( current.Disabled )
+                    current.Reason = "Disabled";
+
+                current.Status = status::Skipped;
+                continue;
+            }
+
+            auto start      = prs::deadline::clock::now();
+            bool result     = Run( current, ssl, analyzer );
+            current.Seconds = std::chrono::duration<double>( prs::deadline::clock::now() - start ).count();
+
+            if( result == current.WillFail )
+            {
+                current.Status = status::Failed;
+                if( result )
+                    current.Reason = "Expected failure";
+            }
+            else
+                current.Reason.clear();
+        }
+
+        ssl.UnloadFile();
+    } );
+
+    size_t passed  = 0;
+    size_t failed  = 0;
+    size_t skipped = 0;
+    double seconds = 0;
+
+    std::cout << "status\tseconds\tfile\treason" << std::endl;
+    for( const auto& current : cases )
+    {
+        char timing[32];
+        std::snprintf( timing, sizeof( timing ), "%.6f", current.Seconds );
+
+        std::string name;
+        switch( current.Status )
+        {
+            case status::Passed:
+                name = "passed";
+                passed++;
+                break;
+            case status::Failed:
+                name = "failed";
+                failed++;
+                break;
+            case status::Skipped:
+                name = "skipped";
+                skipped++;
+                break;
+        }
+
+        std::cout << name << '\t' << timing << '\t' << current.File << '\t' << current.Reason << std::endl;
+        seconds += current.Seconds;
+    }
+
+    prs::executable::Notice( "Passed " + std::to_string( passed ) + ", failed " + std::to_string( failed ) + ", skipped " + std::to_string( skipped ) + " of " + std::to_string( cases.size() ) + " case(s), " + std::to_string( seconds ) + " second(s) total" );
+
+    return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
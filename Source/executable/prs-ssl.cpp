@@ -1,30 +1,274 @@
 #include <cstdlib>
 #include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <memory>
 #include <string>
+#include <vector>
+
+#if defined( _WIN32 )
+    #include <fcntl.h>
+    #include <io.h>
+#endif
 
 #include "executable.hpp"
+#include "prs.analysis.hpp"
 #include "prs.hpp"
+#include "prs.parallel.hpp"
 #include "prs.ssl.hpp"
+#include "prs.stream.hpp"
+
+namespace
+{
+    using ssl_lib = prs::lib<prs::ssl::Lexer, prs::ssl::Parser>;
+
+    const std::string OptionCheck         = "check";
+    const std::string OptionParallel      = "parallel";
+    const std::string OptionParallelChunk = "parallel-chunk";
+    const std::string OptionStream        = "stream";
+
+    bool IsDiagnostics()
+    {
+        return prs::executable::options::IsTokens() || prs::executable::options::IsTrace() || prs::executable::options::IsTree() || prs::executable::options::IsProfile() || prs::executable::options::IsMemstats() || prs::executable::options::IsCounters();
+    }
+
+    // returns false if there's any error
+    bool Report( const std::string& filename, const std::vector<prs::analysis::diagnostic>& diagnostics )
+    {
+        bool result = true;
+
+        for( const auto& diagnostic : diagnostics )
+        {
+            std::string message = filename + ":" + std::to_string( diagnostic.Line ) + ":" + std::to_string( diagnostic.Column ) + " " + diagnostic.Message + " [" + diagnostic.Check + "]";
+
+            if( diagnostic.Severity == prs::analysis::severity::Error )
+            {
+                prs::executable::Error( message );
+                result = false;
+            }
+            else
+                prs::executable::Warning( message );
+        }
+
+        return result;
+    }
+
+    // files are parsed and analyzed in parallel
+    bool CheckBatch( const std::vector<std::string>& files, size_t threads )
+    {
+        prs::analysis::analyzer analyzer;
+        bool                    result = true;
+
+        for( const auto& file : analyzer.Run( files, threads ) )
+        {
+            if( !file.Loaded )
+            {
+                prs::executable::Error( "File cannot be loaded <" + file.File + ">" );
+                result = false;
+                continue;
+            }
+
+            // same format as antlr4::ConsoleErrorListener
+            for( const auto& error : file.Syntax )
+                std::cerr << "line " << error.Line << ":" << error.Column << " " << error.Message << std::endl;
+
+            if( !file.Parsed || !Report( file.File, file.Diagnostics ) )
+                result = false;
+        }
+
+        return result;
+    }
+
+    // workers and their libs are shared by all files, so threads are started and DFA is warmed up once per batch
+    bool ParseParallel( prs::parallel::pool& workers, const std::string& filename )
+    {
+        std::string content;
+        if( !prs::LoadFile( filename, content ) )
+        {
+            prs::executable::Error( "File cannot be loaded <" + filename + ">" );
+            return false;
+        }
+
+        std::unique_ptr<prs::deadline> until = prs::executable::options::Deadline();
+
+        prs::parallel::result result = workers.Parse( content, prs::executable::options::GetParsed()[OptionParallelChunk].as<size_t>(), until.get() );
+
+        // same format as antlr4::ConsoleErrorListener
+        for( const auto& error : result.Diagnostics )
+            std::cerr << "line " << error.Line << ":" << error.Column << " " << error.Message << std::endl;
+
+        if( result.TimedOut )
+            prs::executable::Error( "Parsing timed out <" + filename + ">" );
+
+        return result.Success;
+    }
+
+    // file is read in windows and validated without parse tree, memory use does not depend on file size
+    bool ParseStream( const std::string& filename )
+    {
+        std::ifstream file;
+        std::istream* stream = &std::cin;
+
+        if( filename == "-" )
+        {
+#if defined( _WIN32 )
+            _setmode( _fileno( stdin ), _O_BINARY );
+#endif
+        }
+        else
+        {
+            file.open( filename, std::ios_base::in | std::ios_base::binary );
+            if( !file )
+            {
+                prs::executable::Error( "File cannot be loaded <" + filename + ">" );
+                return false;
+            }
+
+            stream = &file;
+        }
+
+        std::unique_ptr<prs::deadline> until = prs::executable::options::Deadline();
+
+        prs::stream::result result = prs::stream::Validate<prs::ssl::Lexer, prs::ssl::Parser, prs::ssl::Parser::SslContext>(
+            *stream, filename, &prs::ssl::Parser::global_scope,
+            prs::executable::options::GetParsed()[OptionStream].as<size_t>(), prs::executable::options::ErrorLimit(), prs::executable::options::DepthLimit(), until.get() );
+
+        // same format as antlr4::ConsoleErrorListener
+        for( const auto& error : result.Errors )
+            std::cerr << "line " << error.Line << ":" << error.Column << " " << error.Message << std::endl;
+
+        if( result.ErrorLimitReached )
+            prs::executable::Error( "Error limit reached, parsing aborted <" + filename + ">" );
+        if( result.DepthLimitReached )
+            prs::executable::Error( "Nesting limit reached, parsing aborted <" + filename + ">" );
+        if( result.TimedOut )
+            prs::executable::Error( "Parsing timed out <" + filename + ">" );
+
+        return result.Success;
+    }
+}  // namespace
 
 int main( int argc, char** argv )
 {
     prs::executable::Init( argc, argv, "SSL parser" );
     {
         prs::executable::options::AddFile();
+        prs::executable::options::AddBatch();
+        prs::executable::options::AddTimeout();
+        prs::executable::options::AddErrorLimit();
+        prs::executable::options::AddDepthLimit();
+        prs::executable::options::AddBudget();
         prs::executable::options::AddGroupDiagnostics();
+
+        auto option = prs::executable::options::Get().add_options( "Parallel" );
+        option( OptionParallel, "Split each file at top-level boundaries and parse parts concurrently, using given number of threads (0 = all cores)", cxxopts::value<size_t>()->implicit_value( "0" ) );
+        option( OptionParallelChunk, "Minimal part size (bytes)", cxxopts::value<size_t>()->default_value( "65536" ) );
+
+        option = prs::executable::options::Get().add_options( "Stream" );
+        option( OptionStream, "Validate each file without loading it into memory, reading given number of bytes at once; parse tree is not built", cxxopts::value<size_t>()->implicit_value( std::to_string( prs::stream::DefaultWindow ) ) );
+
+        option = prs::executable::options::Get().add_options( "Analysis" );
+        option( OptionCheck, "Run semantic checks on parsed files, using given number of threads (0 = all cores)", cxxopts::value<size_t>()->implicit_value( "0" ) );
     }
 
-    prs::lib<prs::ssl::Lexer, prs::ssl::Parser> ssl;
+    auto& parsed   = prs::executable::options::GetParsed();
+    bool  parallel = parsed.count( OptionParallel ) > 0;
+    bool  check    = parsed.count( OptionCheck ) > 0;
+    bool  stream   = parsed.count( OptionStream ) > 0;
+
+    if( parallel && IsDiagnostics() )
+        prs::executable::Warning( "Diagnostics options are ignored in parallel mode" );
+
+    if( parallel && check )
+        prs::executable::Warning( "Semantic checks are ignored in parallel mode" );
+
+    if( stream && ( parallel || check || IsDiagnostics() ) )
+        prs::executable::Warning( "Parallel, semantic checks and diagnostics options are ignored in stream mode" );
+
+    std::vector<std::string> files = prs::executable::options::Files( "ssl" );
+    prs::executable::options::DiagnosticsStartup( "options" );
+
+    // diagnostics options needs files processed one by one
+    if( check && !parallel && !stream && !IsDiagnostics() && files.size() > 1 )
+        return CheckBatch( files, parsed[OptionCheck].as<size_t>() ) ? EXIT_SUCCESS : EXIT_FAILURE;
+
+    // static data of generated code is initialized on first use, it's done explicitly so it can be measured
+    prs::ssl::Lexer::initialize();
+    prs::executable::options::DiagnosticsStartup( "lexer" );
+    prs::ssl::Parser::initialize();
+    prs::executable::options::DiagnosticsStartup( "parser" );
 
-    std::string filename = prs::executable::options::File();
-    if( !ssl.LoadFile( filename ) )
+    ssl_lib                 ssl;
+    prs::analysis::analyzer analyzer;
+    prs::executable::options::DiagnosticsStartup( "lib" );
+
+    if( prs::executable::options::IsCalibrate() )
+        return prs::executable::options::Calibrate( ssl ) ? EXIT_SUCCESS : EXIT_FAILURE;
+
+    prs::executable::options::DiagnosticsMemstats( ssl );
+    prs::executable::options::DiagnosticsTraceEvents( ssl );
+    prs::executable::options::DiagnosticsCounters( ssl );
+
+    std::unique_ptr<prs::parallel::pool> workers;
+    if( parallel && !stream )
     {
-        prs::executable::Error( "File cannot be loaded <" + filename + ">" );
-        return EXIT_FAILURE;
+        workers = std::make_unique<prs::parallel::pool>(
+            []() {
+                auto lib = std::make_unique<ssl_lib>();
+                prs::executable::options::DiagnosticsTraceEvents( *lib );
+
+                return lib;
+            },
+            parsed[OptionParallel].as<size_t>() );
     }
 
-    bool result = prs::executable::RunParserWithOptions( ssl );
+    bool result = true;
+    for( const auto& filename : files )
+    {
+        if( stream )
+        {
+            if( !ParseStream( filename ) )
+                result = false;
+
+            continue;
+        }
+
+        if( parallel )
+        {
+            if( !ParseParallel( *workers, filename ) )
+                result = false;
+
+            continue;
+        }
+
+        if( !ssl.LoadFile( filename ) )
+        {
+            prs::executable::Error( "File cannot be loaded <" + filename + ">" );
+            result = false;
+            continue;
+        }
+
+        if( !prs::executable::RunParserWithOptions( ssl ) )
+        {
+            if( ssl.IsTimedOut() )
+                prs::executable::Error( "Parsing timed out <" + filename + ">" );
+
+            result = false;
+        }
+        else if( check && !Report( filename, analyzer.Run( prs::analysis::table::Build( ssl.GetLastParseTree(), analyzer.GetNames() ), parsed[OptionCheck].as<size_t>() ) ) )
+            result = false;
+    }
+
+    prs::executable::options::DiagnosticsStartup( "files" );
+
+    prs::executable::options::DiagnosticsProfileResult( ssl );
+    prs::executable::options::DiagnosticsMemstatsResult( ssl );
+    prs::executable::options::DiagnosticsStartupResult();
+    prs::executable::options::DiagnosticsTraceEventsResult();
+    prs::executable::options::DiagnosticsCountersResult();
+
+    if( !prs::executable::options::BudgetResult() )
+        result = false;
 
     return result ? EXIT_SUCCESS : EXIT_FAILURE;
 }
@@ -0,0 +1,497 @@
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+
+#include "prs.json.hpp"
+
+namespace
+{
+    constexpr size_t MaxDepth = 256;
+
+    class reader
+    {
+    private:
+        std::string_view Text;
+        size_t           Pos = 0;
+
+    public:
+        explicit reader( std::string_view text ) :
+            Text( text )
+        {}
+
+        bool Document( prs::json::value& result )
+        {
+            return Value( result, 0 ) && ( SkipSpace(), Pos == Text.size() );
+        }
+
+    private:
+        void SkipSpace()
+        {
+            while( Pos < Text.size() && ( Text[Pos] == ' ' || Text[Pos] == '\t' || Text[Pos] == '\r' || Text[Pos] == '\n' ) )
+                Pos++;
+        }
+
+        bool Consume( char c )
+        {
+            SkipSpace();
+            if( Pos >= Text.size() || Text[Pos] != c )
+                return false;
+
+            Pos++;
+            return true;
+        }
+
+        bool Literal( std::string_view literal )
+        {
+            if( Text.substr( Pos, literal.size() ) != literal )
+                return false;
+
+            Pos += literal.size();
+            return true;
+        }
+
+        bool Value( prs::json::value& result, size_t depth )
+        {
+            SkipSpace();
+            if( Pos >= Text.size() || depth > MaxDepth )
+                return false;
+
+            switch( Text[Pos] )
+            {
+                case '{':
+                    return Object( result, depth );
+                case '[':
+                    return Array( result, depth );
+                case '"':
+                {
+                    std::string string;
+                    if( !String( string ) )
+                        return false;
+
+                    result = std::move( string );
+                    return true;
+                }
+                case 't':
+                    result = true;
+                    return Literal( "true" );
+                case 'f':
+                    result = false;
+                    return Literal( "false" );
+                case 'n':
+                    result = nullptr;
+                    return Literal( "null" );
+                default:
+                    return Number( result );
+            }
+        }
+
+        bool Object( prs::json::value& result, size_t depth )
+        {
+            prs::json::object members;
+
+            Pos++;
+            if( !Consume( '}' ) )
+            {
+                do
+                {
+                    std::string key;
+                    SkipSpace();
+                    if( !String( key ) || !Consume( ':' ) )
+                        return false;
+
+                    prs::json::value member;
+                    if( !Value( member, depth + 1 ) )
+                        return false;
+
+                    members.emplace_back( std::move( key ), std::move( member ) );
+                }
+                while( Consume( ',' ) );
+
+                if( !Consume( '}' ) )
+                    return false;
+            }
+
+            result = std::move( members );
+            return true;
+        }
+
+        bool Array( prs::json::value& result, size_t depth )
+        {
+            prs::json::array elements;
+
+            Pos++;
+            if( !Consume( ']' ) )
+            {
+                do
+                {
+                    prs::json::value element;
+                    if( !Value( element, depth + 1 ) )
+                        return false;
+
+                    elements.push_back( std::move( element ) );
+                }
+                while( Consume( ',' ) );
+
+                if( !Consume( ']' ) )
+                    return false;
+            }
+
+            result = std::move( elements );
+            return true;
+        }
+
+        bool Number( prs::json::value& result )
+        {
+            // from_chars accepts more than JSON does (leading '+', "inf", "nan"), which is fine for reader
+            double number = 0;
+            auto [end, error] = std::from_chars( Text.data() + Pos, Text.data() + Text.size(), number );
+            if( error != std::errc() || end == Text.data() + Pos )
+                return false;
+
+            Pos    = static_cast<size_t>( end - Text.data() );
+            result = number;
+            return true;
+        }
+
+        bool Hex( uint32_t& code )
+        {
+            if( Pos + 4 > Text.size() )
+                return false;
+
+            auto [end, error] = std::from_chars( Text.data() + Pos, Text.data() + Pos + 4, code, 16 );
+            if( error != std::errc() || end != Text.data() + Pos + 4 )
+                return false;
+
+            Pos += 4;
+            return true;
+        }
+
+        static void Append( std::string& string, uint32_t code )
+        {
+            if( code < 0x80 )
+                string += static_cast<char>( code );
+            else if( code < 0x800 )
+            {
+                string += static_cast<char>( 0xC0 | ( code >> 6 ) );
+                string += static_cast<char>( 0x80 | ( code & 0x3F ) );
+            }
+            else if( code < 0x10000 )
+            {
+                string += static_cast<char>( 0xE0 | ( code >> 12 ) );
+                string += static_cast<char>( 0x80 | ( ( code >> 6 ) & 0x3F ) );
+                string += static_cast<char>( 0x80 | ( code & 0x3F ) );
+            }
+            else
+            {
+                string += static_cast<char>( 0xF0 | ( code >> 18 ) );
+                string += static_cast<char>( 0x80 | ( ( code >> 12 ) & 0x3F ) );
+                string += static_cast<char>( 0x80 | ( ( code >> 6 ) & 0x3F ) );
+                string += static_cast<char>( 0x80 | ( code & 0x3F ) );
+            }
+        }
+
+        bool String( std::string& result )
+        {
+            if( Pos >= Text.size() || Text[Pos] != '"' )
+                return false;
+
+            for( Pos++; Pos < Text.size(); )
+            {
+                char c = Text[Pos++];
+                if( c == '"' )
+                    return true;
+                else if( static_cast<unsigned char>( c ) < 0x20 )
+                    return false;
+                else if( c != '\\' )
+                {
+                    result += c;
+                    continue;
+                }
+
+                if( Pos >= Text.size() )
+                    return false;
+
+                switch( Text[Pos++] )
+                {
+                    case '"':
+                        result += '"';
+                        break;
+                    case '\\':
+                        result += '\\';
+                        break;
+                    case '/':
+                        result += '/';
+                        break;
+                    case 'b':
+                        result += '\b';
+                        break;
+                    case 'f':
+                        result += '\f';
+                        break;
+                    case 'n':
+                        result += '\n';
+                        break;
+                    case 'r':
+                        result += '\r';
+                        break;
+                    case 't':
+                        result += '\t';
+                        break;
+                    case 'u':
+                    {
+                        uint32_t code = 0;
+                        if( !Hex( code ) )
+                            return false;
+
+                        // surrogate pair
+                        if( code >= 0xD800 && code < 0xDC00 )
+                        {
+                            uint32_t low = 0;
+                            if( !Literal( "\\u" ) || !Hex( low ) || low < 0xDC00 || low >= 0xE000 )
+                                return false;
+
+                            code = 0x10000 + ( ( code - 0xD800 ) << 10 ) + ( low - 0xDC00 );
+                        }
+
+                        Append( result, code );
+                        break;
+                    }
+                    default:
+                        return false;
+                }
+            }
+
+            return false;
+        }
+    };
+
+    void Write( std::string& out, const prs::json::value& root )
+    {
+        if( root.IsNull() )
+            out += "null";
+        else if( root.IsBool() )
+            out += root.GetBool() ? "true" : "false";
+        else if( root.IsNumber() )
+        {
+            double number = root.GetNumber();
+
+            // integers are written without fraction, so request ids and positions are not turned into floats
+            if( !std::isfinite( number ) )
+                out += "null";
+            else if( std::trunc( number ) == number && std::fabs( number ) < 9007199254740992.0 )
+                out += std::to_string( static_cast<long long>( number ) );
+            else
+            {
+                char buffer[32];
+                auto [end, error] = std::to_chars( buffer, buffer + sizeof( buffer ), number );
+                out.append( buffer, end );
+            }
+        }
+        else if( root.IsString() )
+            prs::json::Escape( out, root.GetString() );
+        else if( root.IsArray() )
+        {
+            out += '[';
+            bool first = true;
+            for( const auto& element : root.GetArray() )
+            {
+                if( !first )
+                    out += ',';
+
+                first = false;
+                Write( out, element );
+            }
+            out += ']';
+        }
+        else
+        {
+            out += '{';
+            bool first = true;
+            for( const auto& [key, member] : root.GetObject() )
+            {
+                if( !first )
+                    out += ',';
+
+                first = false;
+                prs::json::Escape( out, key );
+                out += ':';
+                Write( out, member );
+            }
+            out += '}';
+        }
+    }
+
+    const prs::json::value Null;
+}  // namespace
+
+//
+// value
+//
+
+bool prs::json::value::IsNull() const
+{
+    return std::holds_alternative<std::nullptr_t>( Data );
+}
+
+bool prs::json::value::IsBool() const
+{
+    return std::holds_alternative<bool>( Data );
+}
+
+bool prs::json::value::IsNumber() const
+{
+    return std::holds_alternative<double>( Data );
+}
+
+bool prs::json::value::IsString() const
+{
+    return std::holds_alternative<std::string>( Data );
+}
+
+bool prs::json::value::IsArray() const
+{
+    return std::holds_alternative<array>( Data );
+}
+
+bool prs::json::value::IsObject() const
+{
+    return std::holds_alternative<object>( Data );
+}
+
+bool prs::json::value::GetBool() const
+{
+    const bool* boolean = std::get_if<bool>( &Data );
+
+    return boolean ? *boolean : false;
+}
+
+double prs::json::value::GetNumber() const
+{
+    const double* number = std::get_if<double>( &Data );
+
+    return number ? *number : 0;
+}
+
+const std::string& prs::json::value::GetString() const
+{
+    static const std::string empty;
+    const std::string*       string = std::get_if<std::string>( &Data );
+
+    return string ? *string : empty;
+}
+
+const prs::json::array& prs::json::value::GetArray() const
+{
+    static const array empty;
+    const array*       elements = std::get_if<array>( &Data );
+
+    return elements ? *elements : empty;
+}
+
+const prs::json::object& prs::json::value::GetObject() const
+{
+    static const object empty;
+    const object*       members = std::get_if<object>( &Data );
+
+    return members ? *members : empty;
+}
+
+const prs::json::value* prs::json::value::Find( std::string_view key ) const
+{
+    for( const auto& [name, member] : GetObject() )
+    {
+        if( name == key )
+            return &member;
+    }
+
+    return nullptr;
+}
+
+const prs::json::value& prs::json::value::Get( std::string_view key ) const
+{
+    const value* member = Find( key );
+
+    return member ? *member : Null;
+}
+
+prs::json::value& prs::json::value::operator[]( std::string_view key )
+{
+    if( !IsObject() )
+        Data = object();
+
+    object& members = std::get<object>( Data );
+    for( auto& [name, member] : members )
+    {
+        if( name == key )
+            return member;
+    }
+
+    members.emplace_back( std::string( key ), value() );
+
+    return members.back().second;
+}
+
+void prs::json::value::Push( value element )
+{
+    if( !IsArray() )
+        Data = array();
+
+    std::get<array>( Data ).push_back( std::move( element ) );
+}
+
+//
+// utils
+//
+
+bool prs::json::Parse( std::string_view text, value& result )
+{
+    reader read( text );
+
+    return read.Document( result );
+}
+
+std::string prs::json::Dump( const value& root )
+{
+    std::string out;
+    Write( out, root );
+
+    return out;
+}
+
+void prs::json::Escape( std::string& out, std::string_view string )
+{
+    constexpr char hex[] = "0123456789abcdef";
+
+    out += '"';
+    for( char c : string )
+    {
+        switch( c )
+        {
+            case '"':
+                out += "\\\"";
+                break;
+            case '\\':
+                out += "\\\\";
+                break;
+            case '\n':
+                out += "\\n";
+                break;
+            case '\r':
+                out += "\\r";
+                break;
+            case '\t':
+                out += "\\t";
+                break;
+            default:
+                if( static_cast<unsigned char>( c ) < 0x20 )
+                {
+                    out += "\\u00";
+                    out += hex[( c >> 4 ) & 0xF];
+                    out += hex[c & 0xF];
+                }
+                else
+                    out += c;
+        }
+    }
+    out += '"';
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <concepts>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
+#include <vector>
+
+// minimal JSON document model, reader and writer
+// only what's needed by tools talking to other programs (language server, traces); not optimized for large documents
+
+namespace prs::json
+{
+    class value;
+
+    using array  = std::vector<value>;
+    using object = std::vector<std::pair<std::string, value>>;  // keeps insertion order
+
+    class value
+    {
+    private:
+        std::variant<std::nullptr_t, bool, double, std::string, array, object> Data;
+
+    public:
+        value() :
+            Data( nullptr )
+        {}
+        value( std::nullptr_t ) :
+            Data( nullptr )
+        {}
+        value( bool boolean ) :
+            Data( boolean )
+        {}
+        template<typename T>
+            requires( std::integral<T> || std::floating_point<T> ) && ( !std::same_as<T, bool> )
+        value( T number ) :
+            Data( static_cast<double>( number ) )
+        {}
+        value( const char* string ) :
+            Data( std::string( string ) )
+        {}
+        value( std::string string ) :
+            Data( std::move( string ) )
+        {}
+        value( array elements ) :
+            Data( std::move( elements ) )
+        {}
+        value( object members ) :
+            Data( std::move( members ) )
+        {}
+
+    public:
+        bool IsNull() const;
+        bool IsBool() const;
+        bool IsNumber() const;
+        bool IsString() const;
+        bool IsArray() const;
+        bool IsObject() const;
+
+        // return default value if type does not match
+        bool               GetBool() const;
+        double             GetNumber() const;
+        const std::string& GetString() const;
+        const array&       GetArray() const;
+        const object&      GetObject() const;
+
+        // object members; Get() returns null value if member does not exist or value is not an object
+        const value* Find( std::string_view key ) const;
+        const value& Get( std::string_view key ) const;
+
+        // converts value to object if needed, adds member if it does not exist
+        value& operator[]( std::string_view key );
+
+        // converts value to array if needed
+        void Push( value element );
+    };
+
+    // returns false if text is not a single valid JSON value
+    bool        Parse( std::string_view text, value& result );
+    std::string Dump( const value& root );
+
+    // appends string as quoted JSON string, for writers which don't build a document first
+    void Escape( std::string& out, std::string_view string );
+}  // namespace prs::json
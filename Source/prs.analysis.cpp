@@ -0,0 +1,384 @@
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <tuple>
+
+#include "prs.analysis.hpp"
+#include "prs.ssl.hpp"
+
+namespace
+{
+    using ssl_lib = prs::lib<prs::ssl::Lexer, prs::ssl::Parser>;
+
+    // procedure checks are cheap, starting threads for small files would cost more than running checks
+    constexpr size_t ProcedureThreshold = 64;
+
+    // tokens created by error recovery are not part of input
+    bool IsReal( const antlr4::Token* token )
+    {
+        return token && token->getTokenIndex() != antlr4::INVALID_INDEX;
+    }
+
+    class builder final : public prs::ssl::Walker<builder>
+    {
+    public:
+        prs::analysis::table Table = {};
+
+    private:
+        prs::intern::pool& Names;
+        bool               InBody        = false;
+        bool               InImport      = false;
+        bool               InDeclaration = false;
+
+    public:
+        explicit builder( std::shared_ptr<prs::intern::pool> names ) :
+            Names( *names )
+        {
+            Table.Names = std::move( names );
+        }
+
+    private:
+        // text is viewed in loaded input, same as prs::base::GetTokenText(); only new names are copied
+        prs::analysis::symbol Symbol( const antlr4::Token* token )
+        {
+            const auto*       input = dynamic_cast<const prs::input*>( token->getInputStream() );
+            prs::intern::name name  = input ? Names.Intern( input->View( token->getStartIndex(), token->getStopIndex() ) ) : Names.Intern( token->getText() );
+
+            return { name.Text, name.Id, token->getTokenIndex(), token->getLine(), token->getCharPositionInLine() };
+        }
+
+    public:
+        void EnterProcedureBody( prs::ssl::Parser::ProcedureBodyContext* )
+        {
+            Table.Procedures.emplace_back();
+            InBody = true;
+        }
+
+        void ExitProcedureBody( prs::ssl::Parser::ProcedureBodyContext* )
+        {
+            InBody = false;
+        }
+
+        void EnterProcedureImport( prs::ssl::Parser::ProcedureImportContext* )
+        {
+            InImport = true;
+        }
+
+        void ExitProcedureImport( prs::ssl::Parser::ProcedureImportContext* )
+        {
+            InImport = false;
+        }
+
+        void EnterProcedureDeclaration( prs::ssl::Parser::ProcedureDeclarationContext* )
+        {
+            InDeclaration = true;
+        }
+
+        void ExitProcedureDeclaration( prs::ssl::Parser::ProcedureDeclarationContext* )
+        {
+            InDeclaration = false;
+        }
+
+        void EnterProcedureHead( prs::ssl::Parser::ProcedureHeadContext* context )
+        {
+            if( !IsReal( context->name ) )
+                return;
+
+            if( InImport )
+                Table.ProcedureImports.push_back( Symbol( context->name ) );
+            else if( InDeclaration )
+                Table.ProcedureDeclarations.push_back( Symbol( context->name ) );
+            else if( InBody )
+                Table.Procedures.back().Name = Symbol( context->name );
+        }
+
+        void EnterVariableDeclaration( prs::ssl::Parser::VariableDeclarationContext* context )
+        {
+            auto* head = context->variableHead();
+            if( !head || !IsReal( head->name ) )
+                return;
+
+            if( InBody )
+                Table.Procedures.back().Locals.push_back( Symbol( head->name ) );
+            else
+            {
+                Table.Variables.push_back( Symbol( head->name ) );
+                Table.Globals.emplace( Table.Variables.back().Id, head->name->getTokenIndex() );
+            }
+        }
+
+        void EnterVariableImport( prs::ssl::Parser::VariableImportContext* context )
+        {
+            auto* head = context->variableHead();
+            if( !head || !IsReal( head->name ) )
+                return;
+
+            Table.VariableImports.push_back( Symbol( head->name ) );
+            Table.Globals.emplace( Table.VariableImports.back().Id, head->name->getTokenIndex() );
+        }
+
+        // rule has labeled alternatives, name is searched without knowing which one was matched
+        void EnterVariableOp( prs::ssl::Parser::VariableOpContext* context )
+        {
+            auto* name = context->getToken( prs::ssl::Parser::IDENTIFIER, 0 );
+            if( InBody && name && IsReal( name->getSymbol() ) )
+                Table.Procedures.back().Uses.push_back( Symbol( name->getSymbol() ) );
+        }
+
+        void EnterIfCondition( prs::ssl::Parser::IfConditionContext* context )
+        {
+            if( InBody && IsReal( context->name ) )
+                Table.Procedures.back().Uses.push_back( Symbol( context->name ) );
+        }
+    };
+
+    // local variable declared before use
+    bool IsLocal( const prs::analysis::procedure& body, const prs::analysis::symbol& use )
+    {
+        return std::any_of( body.Locals.begin(), body.Locals.end(), [&use]( const prs::analysis::symbol& local ) {
+            return local.Id == use.Id && local.Index < use.Index;
+        } );
+    }
+
+    // reports every symbol with name used by earlier one
+    void Duplicates( std::vector<prs::analysis::symbol> symbols, prs::analysis::report& output )
+    {
+        std::sort( symbols.begin(), symbols.end(), []( const prs::analysis::symbol& left, const prs::analysis::symbol& right ) {
+            return std::tie( left.Id, left.Index ) < std::tie( right.Id, right.Index );
+        } );
+
+        for( size_t idx = 1; idx < symbols.size(); idx++ )
+        {
+            if( symbols[idx].Id == symbols[idx - 1].Id )
+                output.Add( symbols[idx], "Variable <" + std::string( symbols[idx].Name ) + "> is already declared" );
+        }
+    }
+
+    // work unit of single file analysis; file checks have no procedure
+    struct task
+    {
+        const prs::analysis::check*     Check     = nullptr;
+        const prs::analysis::procedure* Procedure = nullptr;
+    };
+}  // namespace
+
+//
+// table
+//
+
+prs::analysis::table prs::analysis::table::Build( antlr4::tree::ParseTree* tree, std::shared_ptr<prs::intern::pool> names /* = nullptr */ )
+{
+    builder walker( names ? std::move( names ) : std::make_shared<prs::intern::pool>() );
+
+    if( tree )
+        walker.Walk( tree );
+
+    return std::move( walker.Table );
+}
+
+//
+// report
+//
+
+prs::analysis::report::report( const check& owner, std::vector<diagnostic>& output ) :
+    Check( owner ), Output( output )
+{}
+
+void prs::analysis::report::Add( const symbol& at, const std::string& message )
+{
+    Output.push_back( { at.Line, at.Column, Check.Severity, Check.Name, message } );
+}
+
+//
+// checks
+//
+
+std::vector<prs::analysis::check> prs::analysis::DefaultChecks()
+{
+    std::vector<check> result;
+
+    // variables must be declared before use, either in procedure or in global scope
+    check undeclared;
+    undeclared.Name      = "undeclared-variable";
+    undeclared.Severity  = severity::Error;
+    undeclared.Procedure = []( const table& symbols, const procedure& body, report& output ) {
+        for( const auto& use : body.Uses )
+        {
+            if( IsLocal( body, use ) )
+                continue;
+
+            auto global = symbols.Globals.find( use.Id );
+            if( global == symbols.Globals.end() || global->second > use.Index )
+                output.Add( use, "Variable <" + std::string( use.Name ) + "> is not declared" );
+        }
+    };
+    result.push_back( std::move( undeclared ) );
+
+    // global and local scopes are checked separately, local variable can hide global one
+    check duplicate;
+    duplicate.Name     = "duplicate-variable";
+    duplicate.Severity = severity::Error;
+    duplicate.File     = []( const table& symbols, report& output ) {
+        std::vector<symbol> globals = symbols.Variables;
+        globals.insert( globals.end(), symbols.VariableImports.begin(), symbols.VariableImports.end() );
+
+        Duplicates( std::move( globals ), output );
+    };
+    duplicate.Procedure = []( const table& /* symbols */, const procedure& body, report& output ) {
+        Duplicates( body.Locals, output );
+    };
+    result.push_back( std::move( duplicate ) );
+
+    // imported procedures are defined elsewhere
+    check undefined;
+    undefined.Name     = "undefined-procedure";
+    undefined.Severity = severity::Warning;
+    undefined.File     = []( const table& symbols, report& output ) {
+        for( const auto& declaration : symbols.ProcedureDeclarations )
+        {
+            bool defined = std::any_of( symbols.Procedures.begin(), symbols.Procedures.end(), [&declaration]( const procedure& body ) {
+                return body.Name.Id == declaration.Id;
+            } );
+
+            if( !defined )
+                output.Add( declaration, "Procedure <" + std::string( declaration.Name ) + "> is declared but never defined" );
+        }
+    };
+    result.push_back( std::move( undefined ) );
+
+    // only variables are checked, as grammar does not allow calling procedures (yet)
+    check unused;
+    unused.Name     = "unused-import";
+    unused.Severity = severity::Warning;
+    unused.File     = []( const table& symbols, report& output ) {
+        for( const auto& imported : symbols.VariableImports )
+        {
+            bool used = std::any_of( symbols.Procedures.begin(), symbols.Procedures.end(), [&imported]( const procedure& body ) {
+                return std::any_of( body.Uses.begin(), body.Uses.end(), [&imported, &body]( const symbol& use ) {
+                    return use.Id == imported.Id && use.Index > imported.Index && !IsLocal( body, use );
+                } );
+            } );
+
+            if( !used )
+                output.Add( imported, "Imported variable <" + std::string( imported.Name ) + "> is never used" );
+        }
+    };
+    result.push_back( std::move( unused ) );
+
+    return result;
+}
+
+//
+// analyzer
+//
+
+prs::analysis::analyzer::analyzer( std::vector<check> checks /* = DefaultChecks() */ ) :
+    Checks( std::move( checks ) ), Names( std::make_shared<prs::intern::pool>() )
+{}
+
+const std::vector<prs::analysis::check>& prs::analysis::analyzer::GetChecks() const
+{
+    return Checks;
+}
+
+const std::shared_ptr<prs::intern::pool>& prs::analysis::analyzer::GetNames() const
+{
+    return Names;
+}
+
+std::vector<prs::analysis::diagnostic> prs::analysis::analyzer::Run( const table& symbols, size_t threads /* = 0 */ ) const
+{
+    std::vector<task> tasks;
+    for( const auto& current : Checks )
+    {
+        if( current.File )
+            tasks.push_back( { &current, nullptr } );
+
+        if( current.Procedure )
+        {
+            for( const auto& body : symbols.Procedures )
+                tasks.push_back( { &current, &body } );
+        }
+    }
+
+    if( symbols.Procedures.size() < ProcedureThreshold )
+        threads = 1;
+
+    std::vector<std::vector<diagnostic>> outputs( tasks.size() );
+    std::atomic<size_t>                  nextTask = 0;
+
+    prs::parallel::Pool( prs::parallel::Threads( threads, tasks.size() ), [&]() {
+        for( size_t idx = nextTask++; idx < tasks.size(); idx = nextTask++ )
+        {
+            report output( *tasks[idx].Check, outputs[idx] );
+
+            if( tasks[idx].Procedure )
+                tasks[idx].Check->Procedure( symbols, *tasks[idx].Procedure, output );
+            else
+                tasks[idx].Check->File( symbols, output );
+        }
+    } );
+
+    std::vector<diagnostic> result;
+    for( auto& output : outputs )
+        std::move( output.begin(), output.end(), std::back_inserter( result ) );
+
+    Sort( result );
+
+    return result;
+}
+
+std::vector<prs::analysis::file_result> prs::analysis::analyzer::Run( const std::vector<std::string>& files, size_t threads /* = 0 */ ) const
+{
+    std::vector<file_result> result( files.size() );
+    std::atomic<size_t>      nextFile = 0;
+
+    // single file gets all threads for its procedures
+    size_t fileThreads = files.size() == 1 ? threads : 1;
+
+    prs::parallel::Pool( prs::parallel::Threads( threads, files.size() ), [&]() {
+        ssl_lib                  ssl;
+        prs::parallel::collector errors;
+
+        ssl.GetLexer()->removeErrorListeners();
+        ssl.GetLexer()->addErrorListener( &errors );
+        ssl.GetParser()->removeErrorListeners();
+        ssl.GetParser()->addErrorListener( &errors );
+
+        for( size_t idx = nextFile++; idx < files.size(); idx = nextFile++ )
+        {
+            file_result& current = result[idx];
+            current.File         = files[idx];
+
+            errors.Clear();
+            current.Loaded = ssl.LoadFile( files[idx] );
+            if( current.Loaded )
+            {
+                current.Parsed = ssl.ParseAdaptive();
+                current.Syntax = std::move( errors.Get() );
+            }
+
+            if( current.Parsed )
+                current.Diagnostics = Run( table::Build( ssl.GetLastParseTree(), Names ), fileThreads );
+        }
+
+        ssl.UnloadFile();
+        ssl.GetLexer()->removeErrorListener( &errors );
+        ssl.GetParser()->removeErrorListener( &errors );
+    } );
+
+    return result;
+}
+
+//
+// utils
+//
+
+void prs::analysis::Sort( std::vector<diagnostic>& diagnostics )
+{
+    std::stable_sort( diagnostics.begin(), diagnostics.end(), []( const diagnostic& left, const diagnostic& right ) {
+        return std::tie( left.Line, left.Column, left.Check, left.Message ) < std::tie( right.Line, right.Column, right.Check, right.Message );
+    } );
+}
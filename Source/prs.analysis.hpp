@@ -0,0 +1,132 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "prs.hpp"
+#include "prs.intern.hpp"
+#include "prs.parallel.hpp"
+
+// semantic analysis of parsed ssl scripts
+//
+// symbol table is built once per file, with single walk over parse tree, and is read-only afterwards;
+// names are interned, so symbols are compared by id; pool can be shared by tables of many files
+// checks are independent of each other, so they can share it between threads
+//   file checks are run once per file
+//   procedure checks are run once per procedure, in parallel if there's enough procedures to make it worth it
+// files of a batch are analyzed in parallel, one lib instance per worker
+//
+// diagnostics are always sorted by position, check and message, so results do not depend on threads count
+
+namespace prs::analysis
+{
+    enum class severity
+    {
+        Error,
+        Warning
+    };
+
+    struct diagnostic
+    {
+        size_t      Line     = 0;
+        size_t      Column   = 0;
+        severity    Severity = severity::Error;
+        std::string Check    = {};
+        std::string Message  = {};
+    };
+
+    struct symbol
+    {
+        std::string_view Name   = {};  // owned by table names pool
+        prs::intern::id  Id     = 0;
+        size_t           Index  = 0;  // token index, used to tell if declaration precedes use
+        size_t           Line   = 0;
+        size_t           Column = 0;
+    };
+
+    struct procedure
+    {
+        symbol              Name   = {};
+        std::vector<symbol> Locals = {};  // variable declarations
+        std::vector<symbol> Uses   = {};  // variableOp and ifCondition
+    };
+
+    struct table
+    {
+        std::vector<symbol>    Variables             = {};  // global variable declarations
+        std::vector<symbol>    VariableImports       = {};
+        std::vector<symbol>    ProcedureDeclarations = {};  // forward declarations, excluding imports
+        std::vector<symbol>    ProcedureImports      = {};
+        std::vector<procedure> Procedures            = {};
+
+        // global variables (declarations and imports), name id -> token index of first one
+        std::unordered_map<prs::intern::id, size_t> Globals = {};
+
+        std::shared_ptr<prs::intern::pool> Names = {};
+
+        // tree must be created by ssl parser
+        // new pool is created if names is not set
+        static table Build( antlr4::tree::ParseTree* tree, std::shared_ptr<prs::intern::pool> names = nullptr );
+    };
+
+    struct check;
+
+    // collects diagnostics of single check
+    class report
+    {
+    private:
+        const check&             Check;
+        std::vector<diagnostic>& Output;
+
+    public:
+        report( const check& owner, std::vector<diagnostic>& output );
+
+        void Add( const symbol& at, const std::string& message );
+    };
+
+    struct check
+    {
+        std::string Name     = {};
+        severity    Severity = severity::Error;
+
+        // at least one must be set
+        std::function<void( const table& symbols, report& output )>                         File      = {};
+        std::function<void( const table& symbols, const procedure& body, report& output )> Procedure = {};
+    };
+
+    struct file_result
+    {
+        std::string                            File        = {};
+        bool                                   Loaded      = false;
+        bool                                   Parsed      = false;
+        std::vector<prs::parallel::diagnostic> Syntax      = {};  // lexer and parser errors, checks are not run if there's any
+        std::vector<diagnostic>                Diagnostics = {};
+    };
+
+    // undeclared-variable, duplicate-variable, undefined-procedure, unused-import
+    std::vector<check> DefaultChecks();
+
+    class analyzer
+    {
+    private:
+        std::vector<check>                 Checks;
+        std::shared_ptr<prs::intern::pool> Names;  // shared by all files
+
+    public:
+        explicit analyzer( std::vector<check> checks = DefaultChecks() );
+
+    public:
+        const std::vector<check>&                 GetChecks() const;
+        const std::shared_ptr<prs::intern::pool>& GetNames() const;
+
+        // threads == 0 uses std::thread::hardware_concurrency()
+        std::vector<diagnostic>  Run( const table& symbols, size_t threads = 0 ) const;
+        std::vector<file_result> Run( const std::vector<std::string>& files, size_t threads = 0 ) const;
+    };
+
+    void Sort( std::vector<diagnostic>& diagnostics );
+}  // namespace prs::analysis
@@ -0,0 +1,436 @@
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+
+#if defined( PRS_ZLIB )
+    #include <zlib.h>
+#endif
+
+#include "prs.archive.hpp"
+
+namespace
+{
+    // sanity limits, protecting from allocating memory for garbage read from non-archive files
+    constexpr uint32_t MaxNameSize  = 4096;
+    constexpr uint32_t MaxDat1Count = 65536;
+
+    std::string Normalize( std::string_view name )
+    {
+        std::string result( name );
+
+        for( char& ch : result )
+        {
+            if( ch == '\\' )
+                ch = '/';
+            else
+                ch = static_cast<char>( std::tolower( static_cast<unsigned char>( ch ) ) );
+        }
+
+        return result;
+    }
+
+    bool ReadBytes( std::istream& stream, void* data, size_t size )
+    {
+        return static_cast<bool>( stream.read( static_cast<char*>( data ), static_cast<std::streamsize>( size ) ) );
+    }
+
+    bool ReadLE32( std::istream& stream, uint32_t& value )
+    {
+        std::array<uint8_t, 4> bytes;
+        if( !ReadBytes( stream, bytes.data(), bytes.size() ) )
+            return false;
+
+        value = static_cast<uint32_t>( bytes[0] ) | static_cast<uint32_t>( bytes[1] ) << 8 | static_cast<uint32_t>( bytes[2] ) << 16 | static_cast<uint32_t>( bytes[3] ) << 24;
+        return true;
+    }
+
+    bool ReadBE32( std::istream& stream, uint32_t& value )
+    {
+        std::array<uint8_t, 4> bytes;
+        if( !ReadBytes( stream, bytes.data(), bytes.size() ) )
+            return false;
+
+        value = static_cast<uint32_t>( bytes[0] ) << 24 | static_cast<uint32_t>( bytes[1] ) << 16 | static_cast<uint32_t>( bytes[2] ) << 8 | static_cast<uint32_t>( bytes[3] );
+        return true;
+    }
+
+    bool ReadName( std::istream& stream, size_t size, std::string& name )
+    {
+        name.resize( size );
+
+        return size == 0 || ReadBytes( stream, name.data(), size );
+    }
+
+    // Fallout 1 variant: sequence of blocks prefixed with signed 16-bit big-endian size
+    //   size < 0 ... -size bytes stored as-is
+    //   size > 0 ... size bytes of LZSS data; 4096 bytes dictionary filled with spaces, flag bit set = literal, unset = 12-bit offset and 4-bit length (+3)
+    //   size = 0 ... end of data
+    bool UnpackLZSS( std::string_view packed, std::string& content, size_t size )
+    {
+        constexpr size_t DictionarySize  = 4096;
+        constexpr size_t DictionaryStart = 4078;
+        constexpr size_t MatchMin        = 3;
+
+        std::array<char, DictionarySize> dictionary;
+        size_t                           pos = 0;
+
+        content.clear();
+        content.reserve( size );
+
+        while( pos + 2 <= packed.size() && content.size() < size )
+        {
+            int16_t block = static_cast<int16_t>( static_cast<uint8_t>( packed[pos] ) << 8 | static_cast<uint8_t>( packed[pos + 1] ) );
+            pos += 2;
+
+            if( block == 0 )
+                break;
+            else if( block < 0 )
+            {
+                size_t length = static_cast<size_t>( -block );
+                if( pos + length > packed.size() )
+                    return false;
+
+                content.append( packed.substr( pos, length ) );
+                pos += length;
+                continue;
+            }
+
+            size_t end = pos + static_cast<size_t>( block );
+            if( end > packed.size() )
+                return false;
+
+            dictionary.fill( ' ' );
+            size_t dictionaryPos = DictionaryStart;
+
+            while( pos < end )
+            {
+                uint8_t flags = static_cast<uint8_t>( packed[pos++] );
+
+                for( size_t bit = 0; bit < 8 && pos < end; bit++, flags >>= 1 )
+                {
+                    if( flags & 1 )
+                    {
+                        char ch = packed[pos++];
+
+                        content += ch;
+                        dictionary[dictionaryPos++ % DictionarySize] = ch;
+                        continue;
+                    }
+
+                    if( pos + 2 > end )
+                        return false;
+
+                    uint8_t low  = static_cast<uint8_t>( packed[pos] );
+                    uint8_t high = static_cast<uint8_t>( packed[pos + 1] );
+                    pos += 2;
+
+                    size_t offset = low | static_cast<size_t>( high & 0xF0 ) << 4;
+                    size_t length = static_cast<size_t>( high & 0x0F ) + MatchMin;
+
+                    for( size_t idx = 0; idx < length; idx++ )
+                    {
+                        char ch = dictionary[( offset + idx ) % DictionarySize];
+
+                        content += ch;
+                        dictionary[dictionaryPos++ % DictionarySize] = ch;
+                    }
+                }
+            }
+        }
+
+        return content.size() == size;
+    }
+
+#if defined( PRS_ZLIB )
+    constexpr size_t ReadSize = 65536;
+
+    // input is streamed in fixed-size chunks, output is written directly into content
+    bool UnpackZlib( std::istream& stream, uint32_t packedSize, std::string& content, size_t size )
+    {
+        thread_local std::string input;
+        input.resize( ReadSize );
+
+        content.resize( size );
+
+        z_stream zlib = {};
+        if( inflateInit( &zlib ) != Z_OK )
+            return false;
+
+        zlib.next_out  = reinterpret_cast<Bytef*>( content.data() );
+        zlib.avail_out = static_cast<uInt>( size );
+
+        int    status    = Z_OK;
+        size_t remaining = packedSize;
+        while( status == Z_OK && remaining > 0 )
+        {
+            size_t chunk = std::min( remaining, ReadSize );
+            if( !ReadBytes( stream, input.data(), chunk ) )
+                break;
+
+            remaining -= chunk;
+
+            zlib.next_in  = reinterpret_cast<Bytef*>( input.data() );
+            zlib.avail_in = static_cast<uInt>( chunk );
+
+            status = inflate( &zlib, Z_NO_FLUSH );
+        }
+
+        bool result = status == Z_STREAM_END && zlib.total_out == size;
+        inflateEnd( &zlib );
+
+        return result;
+    }
+#endif
+
+    std::mutex                                                              ArchivesLock;
+    std::unordered_map<std::string, std::shared_ptr<prs::archive::archive>> Archives;
+}  // namespace
+
+//
+// archive
+//
+
+bool prs::archive::archive::Open( const std::string& filename )
+{
+    Filename = filename;
+    Entries.clear();
+    Index.clear();
+
+    std::ifstream stream( filename, std::ios_base::in | std::ios_base::binary );
+    if( !stream )
+        return false;
+
+    stream.seekg( 0, std::ios_base::end );
+    uint64_t fileSize = static_cast<uint64_t>( stream.tellg() );
+    stream.seekg( 0, std::ios_base::beg );
+
+    // DAT2 ends with directory size and file size, DAT1 has no signature at all
+    bool result = OpenDat2( stream, fileSize );
+    if( !result )
+    {
+        Entries.clear();
+        Index.clear();
+
+        stream.clear();
+        stream.seekg( 0, std::ios_base::beg );
+        result = OpenDat1( stream, fileSize );
+    }
+
+    if( !result )
+    {
+        Entries.clear();
+        Index.clear();
+    }
+
+    return result;
+}
+
+const std::string& prs::archive::archive::GetFilename() const
+{
+    return Filename;
+}
+
+const std::vector<prs::archive::entry>& prs::archive::archive::GetEntries() const
+{
+    return Entries;
+}
+
+const prs::archive::entry* prs::archive::archive::Find( std::string_view name ) const
+{
+    auto it = Index.find( Normalize( name ) );
+
+    return it != Index.end() ? &Entries[it->second] : nullptr;
+}
+
+bool prs::archive::archive::Read( const entry& current, std::string& content ) const
+{
+    std::ifstream stream( Filename, std::ios_base::in | std::ios_base::binary );
+    if( !stream || !stream.seekg( current.Offset ) )
+        return false;
+
+    switch( current.Compression )
+    {
+        case compression::None:
+            content.resize( current.Size );
+            return ReadBytes( stream, content.data(), content.size() );
+        case compression::LZSS:
+        {
+            // packed data is kept in per-thread buffer, reused by following reads
+            thread_local std::string packed;
+            packed.resize( current.PackedSize );
+
+            return ReadBytes( stream, packed.data(), packed.size() ) && UnpackLZSS( packed, content, current.Size );
+        }
+        case compression::Zlib:
+#if defined( PRS_ZLIB )
+            return UnpackZlib( stream, current.PackedSize, content, current.Size );
+#else
+            return false;
+#endif
+    }
+
+    return false;
+}
+
+// header: directories count, 3 * unknown
+// directories names: size (uint8), name
+// for each directory: files count, 3 * unknown, then for each file: size (uint8), name, attributes (0x40 = LZSS), offset, size, packed size
+bool prs::archive::archive::OpenDat1( std::istream& stream, uint64_t fileSize )
+{
+    std::array<uint32_t, 4> header;
+    for( auto& value : header )
+    {
+        if( !ReadBE32( stream, value ) )
+            return false;
+    }
+
+    uint32_t directories = header[0];
+    if( directories == 0 || directories > MaxDat1Count )
+        return false;
+
+    std::vector<std::string> names( directories );
+    for( auto& name : names )
+    {
+        uint8_t size;
+        if( !ReadBytes( stream, &size, 1 ) || !ReadName( stream, size, name ) )
+            return false;
+
+        name = name == "." ? std::string() : name + "/";
+    }
+
+    for( const auto& directory : names )
+    {
+        std::array<uint32_t, 4> info;
+        for( auto& value : info )
+        {
+            if( !ReadBE32( stream, value ) )
+                return false;
+        }
+
+        if( info[0] > MaxDat1Count )
+            return false;
+
+        for( uint32_t file = 0; file < info[0]; file++ )
+        {
+            uint8_t     size;
+            std::string name;
+            uint32_t    attributes;
+            entry       current;
+
+            if( !ReadBytes( stream, &size, 1 ) || !ReadName( stream, size, name ) || !ReadBE32( stream, attributes ) || !ReadBE32( stream, current.Offset ) || !ReadBE32( stream, current.Size ) || !ReadBE32( stream, current.PackedSize ) )
+                return false;
+
+            current.Name        = directory + name;
+            current.Compression = attributes & 0x40 ? compression::LZSS : compression::None;
+
+            if( current.Compression == compression::None )
+                current.PackedSize = current.Size;
+
+            if( !AddEntry( std::move( current ), fileSize ) )
+                return false;
+        }
+    }
+
+    return true;
+}
+
+// footer: directory size, file size
+// directory: files count, then for each file: name size, name, type (1 = zlib), size, packed size, offset
+bool prs::archive::archive::OpenDat2( std::istream& stream, uint64_t fileSize )
+{
+    uint32_t directorySize;
+    uint32_t dataSize;
+
+    if( fileSize < 12 || !stream.seekg( static_cast<std::streamoff>( fileSize - 8 ) ) || !ReadLE32( stream, directorySize ) || !ReadLE32( stream, dataSize ) )
+        return false;
+
+    if( dataSize != fileSize || static_cast<uint64_t>( directorySize ) + 8 > fileSize )
+        return false;
+
+    uint32_t files;
+    if( !stream.seekg( static_cast<std::streamoff>( fileSize - 8 - directorySize ) ) || !ReadLE32( stream, files ) )
+        return false;
+
+    for( uint32_t file = 0; file < files; file++ )
+    {
+        uint32_t nameSize;
+        uint8_t  type;
+        entry    current;
+
+        if( !ReadLE32( stream, nameSize ) || nameSize > MaxNameSize || !ReadName( stream, nameSize, current.Name ) || !ReadBytes( stream, &type, 1 ) || !ReadLE32( stream, current.Size ) || !ReadLE32( stream, current.PackedSize ) || !ReadLE32( stream, current.Offset ) )
+            return false;
+
+        current.Compression = type ? compression::Zlib : compression::None;
+
+        if( !AddEntry( std::move( current ), fileSize ) )
+            return false;
+    }
+
+    return true;
+}
+
+bool prs::archive::archive::AddEntry( entry&& current, uint64_t fileSize )
+{
+    if( static_cast<uint64_t>( current.Offset ) + current.PackedSize > fileSize )
+        return false;
+
+    std::replace( current.Name.begin(), current.Name.end(), '\\', '/' );
+
+    Index.emplace( Normalize( current.Name ), Entries.size() );
+    Entries.push_back( std::move( current ) );
+
+    return true;
+}
+
+//
+// utils
+//
+
+bool prs::archive::IsArchive( std::string_view filename )
+{
+    return IsExtension( filename, "dat" );
+}
+
+bool prs::archive::IsExtension( std::string_view name, std::string_view extension )
+{
+    return name.size() > extension.size() + 1 && name[name.size() - extension.size() - 1] == '.' && Normalize( name.substr( name.size() - extension.size() ) ) == Normalize( extension );
+}
+
+bool prs::archive::Split( const std::string& filename, std::string& archiveName, std::string& entryName )
+{
+    // shortest existing .dat prefix wins, archives are never nested
+    for( size_t pos = filename.find_first_of( "/\\" ); pos != std::string::npos; pos = filename.find_first_of( "/\\", pos + 1 ) )
+    {
+        std::string_view prefix( filename.data(), pos );
+        if( !IsArchive( prefix ) || !std::filesystem::is_regular_file( std::string( prefix ) ) )
+            continue;
+
+        archiveName = prefix;
+        entryName   = filename.substr( pos + 1 );
+
+        return !entryName.empty();
+    }
+
+    return false;
+}
+
+std::shared_ptr<const prs::archive::archive> prs::archive::Get( const std::string& filename )
+{
+    std::lock_guard<std::mutex> lock( ArchivesLock );
+
+    auto it = Archives.find( filename );
+    if( it != Archives.end() )
+        return it->second;
+
+    auto result = std::make_shared<archive>();
+    if( !result->Open( filename ) )
+        result = nullptr;
+
+    // failed attempts are cached too, so missing entries doesn't read directory again
+    Archives.emplace( filename, result );
+
+    return result;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Fallout .dat archives reader
+// DAT1 (Fallout 1): big-endian directory, entries stored as-is or LZSS-compressed
+// DAT2 (Fallout 2): little-endian directory at the end of file, entries stored as-is or zlib-compressed (requires PRS_ZLIB)
+//
+// archive entries can be used as regular files by prs::LoadFile(), as <archive.dat>/<entry>;
+// entry names are case-insensitive, and accepts both '/' and '\' as separator
+
+namespace prs::archive
+{
+    enum class compression
+    {
+        None,
+        LZSS,
+        Zlib
+    };
+
+    struct entry
+    {
+        std::string Name        = {};  // as stored in archive, with '/' as separator
+        compression Compression = compression::None;
+        uint32_t    Offset      = 0;
+        uint32_t    Size        = 0;  // unpacked
+        uint32_t    PackedSize  = 0;
+    };
+
+    class archive
+    {
+    private:
+        std::string                             Filename = {};
+        std::vector<entry>                      Entries  = {};
+        std::unordered_map<std::string, size_t> Index    = {};  // normalized name -> Entries index
+
+    public:
+        // reads archive directory only, entries are read on demand; returns false if file is not a valid DAT1/DAT2 archive
+        bool Open( const std::string& filename );
+
+        const std::string&        GetFilename() const;
+        const std::vector<entry>& GetEntries() const;
+        const entry*              Find( std::string_view name ) const;
+
+        // content is replaced with unpacked entry, its capacity is reused; returns false if entry cannot be read or unpacked
+        // can be called from multiple threads at once
+        bool Read( const entry& current, std::string& content ) const;
+
+    private:
+        bool OpenDat1( std::istream& stream, uint64_t fileSize );
+        bool OpenDat2( std::istream& stream, uint64_t fileSize );
+        bool AddEntry( entry&& current, uint64_t fileSize );
+    };
+
+    // returns true if filename looks like archive (.dat extension, case-insensitive)
+    bool IsArchive( std::string_view filename );
+
+    // case-insensitive, extension is given without dot
+    bool IsExtension( std::string_view name, std::string_view extension );
+
+    // splits <archive.dat>/<entry> path; returns false if filename does not point inside archive
+    bool Split( const std::string& filename, std::string& archiveName, std::string& entryName );
+
+    // opened archives are kept until program ends, so their directory is read only once; thread-safe
+    // returns nullptr if archive cannot be opened
+    std::shared_ptr<const archive> Get( const std::string& filename );
+}  // namespace prs::archive
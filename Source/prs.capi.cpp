@@ -0,0 +1,224 @@
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "prs.capi.h"
+#include "prs.hpp"
+#include "prs.ssl.hpp"
+#include "prs.tree.hpp"
+
+#if ANTLR4_USE_THREAD_LOCAL_CACHE
+namespace
+{
+    // unlike std::thread::id, never reused once thread exits
+    size_t ThreadSerial()
+    {
+        static std::atomic<size_t> counter = 0;
+        thread_local size_t        serial  = ++counter;
+
+        return serial;
+    }
+}  // namespace
+#endif
+
+struct prs_parser
+{
+    using ssl_lib = prs::lib<prs::ssl::Lexer, prs::ssl::Parser>;
+
+    ssl_lib Lib = {};
+
+    // results of last prs_parse() call
+    std::vector<prs_token>         Tokens     = {};
+    std::vector<std::string>       TokensText = {};
+    std::vector<prs_error>         Errors     = {};
+    std::vector<prs::syntax_error> ErrorsData = {};
+    std::string                    Tree       = {};
+    std::string                    LastError  = {};
+
+    std::vector<std::string> Names = {};  // token names, indexed by type
+
+#if ANTLR4_USE_THREAD_LOCAL_CACHE
+    // lexer and parser uses ATN/DFA data of thread which created them
+    const size_t Thread = ThreadSerial();
+#endif
+
+    prs_parser()
+    {
+        Lib.CollectErrors();
+
+        const antlr4::dfa::Vocabulary& vocabulary = Lib.GetLexer()->getVocabulary();
+        for( size_t type = 0; type <= vocabulary.getMaxTokenType(); type++ )
+            Names.emplace_back( vocabulary.getSymbolicName( type ) );
+    }
+
+    void Clear()
+    {
+        Tokens.clear();
+        TokensText.clear();
+        Errors.clear();
+        ErrorsData.clear();
+        Tree.clear();
+        LastError.clear();
+    }
+
+    // must be called before UnloadFile(), as tokens text is read from input
+    void Collect( unsigned flags )
+    {
+        if( flags & PRS_FLAG_TOKENS )
+        {
+            Lib.FillTokens();
+
+            for( const auto& token : Lib.GetTokens()->getTokens() )
+            {
+                Tokens.push_back( { token->getType(), token->getTokenIndex(), token->getLine(), token->getCharPositionInLine() + 1, nullptr } );
+                TokensText.push_back( token->getText() );
+            }
+        }
+
+        if( ( flags & PRS_FLAG_TREE ) && Lib.GetLastParseTree() )
+            Tree = prs::tree::ToString( Lib.GetLastParseTree(), Lib.GetParser()->getRuleNames() );
+
+        // errors are cleared by UnloadFile()
+        ErrorsData = Lib.GetErrors();
+
+        // pointers are set once vectors are not going to grow anymore
+        for( size_t idx = 0; idx < Tokens.size(); idx++ )
+            Tokens[idx].text = TokensText[idx].c_str();
+        for( const auto& error : ErrorsData )
+            Errors.push_back( { error.Line, error.Column + 1, error.Token.c_str(), error.Message.c_str() } );
+    }
+};
+
+unsigned prs_version( void )
+{
+    return ( PROJECT_VERSION_MAJOR << 16 ) | PROJECT_VERSION_MINOR;
+}
+
+prs_parser* prs_create( void )
+{
+    try
+    {
+        return new prs_parser();
+    }
+    catch( ... )
+    {
+        return nullptr;
+    }
+}
+
+void prs_destroy( prs_parser* parser )
+{
+    delete parser;
+}
+
+prs_status prs_parse( prs_parser* parser, const char* data, size_t size, const char* name, const prs_options* options )
+{
+    if( !parser )
+        return PRS_INVALID;
+
+    parser->Clear();
+
+#if ANTLR4_USE_THREAD_LOCAL_CACHE
+    if( parser->Thread != ThreadSerial() )
+    {
+        parser->LastError = "handle used outside of thread which created it";
+        return PRS_INVALID;
+    }
+#endif
+
+    if( !data && size > 0 )
+    {
+        parser->LastError = "data is NULL";
+        return PRS_INVALID;
+    }
+
+    prs_options current = options ? *options : prs_options{ 0, 0, 0 };
+    if( current.timeout < 0 )
+    {
+        parser->LastError = "timeout is negative";
+        return PRS_INVALID;
+    }
+
+    prs_status result = PRS_INVALID;
+
+    try
+    {
+        std::unique_ptr<prs::deadline> until;
+        if( current.timeout > 0 )
+            until = std::make_unique<prs::deadline>( std::chrono::duration_cast<prs::deadline::clock::duration>( std::chrono::duration<double>( current.timeout ) ) );
+
+        // errors are collected since handle creation, limit is the only thing which changes between calls
+        parser->Lib.CollectErrors( current.error_limit );
+        parser->Lib.LoadBuffer( std::string_view( data ? data : "", size ), name ? name : "" );
+
+        bool success = parser->Lib.ParseAdaptive( until.get() );
+
+        if( parser->Lib.IsTimedOut() )
+            result = PRS_TIMEOUT;
+        else if( parser->Lib.IsErrorLimitReached() )
+            result = PRS_ERROR_LIMIT;
+        else if( !success || !parser->Lib.GetErrors().empty() )
+            result = PRS_SYNTAX;
+        else
+            result = PRS_OK;
+
+        parser->Collect( current.flags );
+    }
+    catch( const std::exception& e )
+    {
+        parser->Clear();
+        parser->LastError = e.what();
+        result            = PRS_INVALID;
+    }
+    catch( ... )
+    {
+        parser->Clear();
+        parser->LastError = "unknown exception";
+        result            = PRS_INVALID;
+    }
+
+    // borrowed buffer must not be touched after returning
+    parser->Lib.UnloadFile();
+
+    return result;
+}
+
+size_t prs_tokens( prs_parser* parser, const prs_token** tokens )
+{
+    if( !parser || !tokens )
+        return 0;
+
+    *tokens = parser->Tokens.data();
+    return parser->Tokens.size();
+}
+
+size_t prs_errors( prs_parser* parser, const prs_error** errors )
+{
+    if( !parser || !errors )
+        return 0;
+
+    *errors = parser->Errors.data();
+    return parser->Errors.size();
+}
+
+const char* prs_tree( prs_parser* parser )
+{
+    return parser ? parser->Tree.c_str() : "";
+}
+
+const char* prs_last_error( prs_parser* parser )
+{
+    return parser ? parser->LastError.c_str() : "";
+}
+
+const char* prs_token_name( prs_parser* parser, size_t type )
+{
+    if( !parser || type >= parser->Names.size() )
+        return "";
+
+    return parser->Names[type].c_str();
+}
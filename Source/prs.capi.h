@@ -0,0 +1,98 @@
+#ifndef PRS_CAPI_H
+#define PRS_CAPI_H
+
+#include <stddef.h>
+
+// C API of SSL parser, built as shared library
+//
+// parser handles are reusable, and must not be shared between threads without external locking;
+// different handles can be used from different threads at the same time
+//
+// by default (PRS_ANTLR_THREAD_LOCAL_CACHE), ANTLR keeps its DFA cache per thread, and handle uses cache of thread which created it;
+// prs_parse() called from any other thread returns PRS_INVALID, as that cache is freed once creating thread exits
+// handles which needs to move between threads requires library built with PRS_ANTLR_THREAD_LOCAL_CACHE=OFF
+//
+// data returned by prs_tokens(), prs_errors() and prs_tree() is owned by handle, and stays valid until next prs_parse() or prs_destroy() call
+
+#if defined( _WIN32 )
+    #if defined( PRS_CAPI_EXPORTS )
+        #define PRS_API __declspec( dllexport )
+    #else
+        #define PRS_API __declspec( dllimport )
+    #endif
+#else
+    #define PRS_API __attribute__( ( visibility( "default" ) ) )
+#endif
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    typedef struct prs_parser prs_parser;
+
+    typedef enum prs_status
+    {
+        PRS_OK          = 0,
+        PRS_SYNTAX      = 1,  // syntax errors found, see prs_errors()
+        PRS_TIMEOUT     = 2,
+        PRS_ERROR_LIMIT = 3,  // prs_options.error_limit reached, parsing aborted
+        PRS_INVALID     = 4,  // invalid arguments or internal error, see prs_last_error()
+    } prs_status;
+
+    // prs_options.flags
+    enum
+    {
+        PRS_FLAG_TOKENS = 0x01,  // collect tokens, see prs_tokens()
+        PRS_FLAG_TREE   = 0x02,  // build parse tree string, see prs_tree()
+    };
+
+    typedef struct prs_options
+    {
+        unsigned flags;
+        double   timeout;      // seconds, 0 = no limit
+        size_t   error_limit;  // 0 = no limit
+    } prs_options;
+
+    typedef struct prs_token
+    {
+        size_t      type;  // see prs_token_name()
+        size_t      index;
+        size_t      line;
+        size_t      column;  // 1-based
+        const char* text;    // null-terminated, UTF-8
+    } prs_token;
+
+    typedef struct prs_error
+    {
+        size_t      line;
+        size_t      column;  // 1-based
+        const char* token;   // offending token text, empty for lexer errors
+        const char* message;
+    } prs_error;
+
+    // returns (major << 16) | minor
+    PRS_API unsigned prs_version( void );
+
+    // returns NULL if handle cannot be created
+    PRS_API prs_parser* prs_create( void );
+    PRS_API void        prs_destroy( prs_parser* parser );
+
+    // data must be UTF-8 and stay valid during call only, it's never copied; name is used in diagnostics, can be NULL
+    // options can be NULL
+    PRS_API prs_status prs_parse( prs_parser* parser, const char* data, size_t size, const char* name, const prs_options* options );
+
+    // results of last prs_parse() call
+    PRS_API size_t      prs_tokens( prs_parser* parser, const prs_token** tokens );
+    PRS_API size_t      prs_errors( prs_parser* parser, const prs_error** errors );
+    PRS_API const char* prs_tree( prs_parser* parser );
+    PRS_API const char* prs_last_error( prs_parser* parser );
+
+    // returns symbolic name of token type, or empty string if type is unknown
+    PRS_API const char* prs_token_name( prs_parser* parser, size_t type );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // PRS_CAPI_H
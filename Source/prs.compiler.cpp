@@ -0,0 +1,451 @@
+#include <algorithm>
+#include <charconv>
+#include <iterator>
+#include <tuple>
+#include <unordered_map>
+
+#include "prs.compiler.hpp"
+#include "prs.ssl.hpp"
+
+namespace
+{
+    constexpr uint32_t None = 0xFFFFFFFF;
+
+    const std::string CheckName = "compile";
+
+    enum class storage
+    {
+        Local,
+        Global,
+        External
+    };
+
+    struct variable
+    {
+        storage  Storage = storage::Global;
+        uint32_t Index   = 0;  // stack index for locals and globals, identifier offset for externals
+    };
+
+    struct entry
+    {
+        prs::analysis::symbol Name     = {};
+        uint32_t              Flags    = 0;
+        uint32_t              Body     = 0;
+        bool                  Imported = false;
+        bool                  Defined  = false;
+    };
+
+    void Error( std::vector<prs::analysis::diagnostic>& output, const prs::analysis::symbol& at, const std::string& message )
+    {
+        output.push_back( { at.Line, at.Column, prs::analysis::severity::Error, CheckName, message } );
+    }
+
+    // size of identifier entry, without int16 size
+    uint16_t IdentifierSize( const std::string& name )
+    {
+        return static_cast<uint16_t>( ( name.size() + 2 ) & ~size_t( 1 ) );
+    }
+
+    class generator final : public prs::ssl::Walker<generator>
+    {
+    public:
+        prs::compiler::bytecode                Code        = {};
+        std::vector<int32_t>                   Values      = {};  // initial values of globals
+        std::vector<prs::analysis::diagnostic> Diagnostics = {};
+
+    private:
+        const prs::analysis::table&                      Symbols;
+        const std::unordered_map<std::string, variable>& Globals;
+        std::unordered_map<std::string, entry*>&         Procedures;
+        const uint32_t                                   CodeStart;
+
+        std::unordered_map<std::string, variable> Locals = {};
+        std::vector<size_t>                       Blocks = {};  // position of if address, None for blocks without head
+        size_t                                    Body   = 0;   // index of current procedure in Symbols.Procedures
+        uint32_t                                  Start  = 0;   // address of current procedure
+        bool                                      InBody = false;
+
+    public:
+        generator( const prs::analysis::table& symbols, const std::unordered_map<std::string, variable>& globals, std::unordered_map<std::string, entry*>& procedures, uint32_t codeStart ) :
+            Symbols( symbols ), Globals( globals ), Procedures( procedures ), CodeStart( codeStart )
+        {}
+
+    private:
+        uint32_t Address() const
+        {
+            return CodeStart + static_cast<uint32_t>( Code.Size() );
+        }
+
+        int32_t Number( const antlr4::Token* token )
+        {
+            std::string text  = token->getText();
+            int32_t     value = 0;
+
+            auto [end, error] = std::from_chars( text.data(), text.data() + text.size(), value );
+            if( error != std::errc() || end != text.data() + text.size() )
+                Error( Diagnostics, { {}, 0, token->getTokenIndex(), token->getLine(), token->getCharPositionInLine() }, "Number <" + text + "> is out of range" );
+
+            return value;
+        }
+
+        // locals are declared before use, analysis makes sure of that
+        const variable* Find( const std::string& name ) const
+        {
+            auto local = Locals.find( name );
+            if( local != Locals.end() )
+                return &local->second;
+
+            auto global = Globals.find( name );
+            if( global != Globals.end() )
+                return &global->second;
+
+            return nullptr;
+        }
+
+        void Fetch( const variable& target )
+        {
+            Code.Push( static_cast<int32_t>( target.Index ) );
+
+            switch( target.Storage )
+            {
+                case storage::Local:
+                    Code.Op( prs::compiler::opcode::Fetch );
+                    break;
+                case storage::Global:
+                    Code.Op( prs::compiler::opcode::FetchGlobal );
+                    break;
+                case storage::External:
+                    Code.Op( prs::compiler::opcode::FetchExternal );
+                    break;
+            }
+        }
+
+        // value must be on stack already
+        void Store( const variable& target )
+        {
+            Code.Push( static_cast<int32_t>( target.Index ) );
+
+            switch( target.Storage )
+            {
+                case storage::Local:
+                    Code.Op( prs::compiler::opcode::Store );
+                    break;
+                case storage::Global:
+                    Code.Op( prs::compiler::opcode::StoreGlobal );
+                    break;
+                case storage::External:
+                    Code.Op( prs::compiler::opcode::StoreExternal );
+                    break;
+            }
+        }
+
+    public:
+        // locals are reserved on procedure start, declarations only set their values
+        void EnterProcedureBody( prs::ssl::Parser::ProcedureBodyContext* )
+        {
+            Start  = Address();
+            InBody = true;
+            Locals.clear();
+
+            Code.Op( prs::compiler::opcode::PushBase );
+            for( size_t idx = 0; idx < Symbols.Procedures[Body].Locals.size(); idx++ )
+                Code.Push( 0 );
+        }
+
+        void ExitProcedureBody( prs::ssl::Parser::ProcedureBodyContext* )
+        {
+            Code.Op( prs::compiler::opcode::PopToBase );
+            Code.Op( prs::compiler::opcode::PopBase );
+            Code.Push( 0 );
+            Code.Op( prs::compiler::opcode::PopReturn );
+
+            InBody = false;
+            Body++;
+        }
+
+        void EnterProcedureHead( prs::ssl::Parser::ProcedureHeadContext* context )
+        {
+            if( InBody )
+                Procedures.at( context->name->getText() )->Body = Start;
+        }
+
+        void EnterVariableDeclaration( prs::ssl::Parser::VariableDeclarationContext* context )
+        {
+            int32_t value = context->value ? Number( context->value ) : 0;
+
+            if( !InBody )
+            {
+                Values.push_back( value );
+                return;
+            }
+
+            variable local = { storage::Local, static_cast<uint32_t>( Locals.size() ) };
+            Locals.emplace( context->variableHead()->name->getText(), local );
+
+            if( context->value )
+            {
+                Code.Push( value );
+                Store( local );
+            }
+        }
+
+        // rule has labeled alternatives, name is searched without knowing which one was matched
+        void EnterVariableOp( prs::ssl::Parser::VariableOpContext* context )
+        {
+            const variable* target = Find( context->getToken( prs::ssl::Parser::IDENTIFIER, 0 )->getText() );
+            if( !target )
+                return;
+
+            Fetch( *target );
+            Code.Push( 1 );
+            Code.Op( prs::compiler::opcode::Add );
+            Store( *target );
+        }
+
+        // if pops condition first, then address to jump to if condition is false
+        void EnterBlock( prs::ssl::Parser::BlockContext* context )
+        {
+            if( !context->blockHead() )
+            {
+                Blocks.push_back( None );
+                return;
+            }
+
+            Code.Op( prs::compiler::opcode::Int );
+            Blocks.push_back( Code.Size() );
+            Code.Int32( 0 );
+        }
+
+        void ExitBlock( prs::ssl::Parser::BlockContext* )
+        {
+            if( Blocks.back() != None )
+                Code.Patch( Blocks.back(), Address() );
+
+            Blocks.pop_back();
+        }
+
+        void ExitBlockHead( prs::ssl::Parser::BlockHeadContext* )
+        {
+            Code.Op( prs::compiler::opcode::If );
+        }
+
+        void EnterIfCondition( prs::ssl::Parser::IfConditionContext* context )
+        {
+            if( context->name )
+            {
+                if( const variable* target = Find( context->name->getText() ) )
+                    Fetch( *target );
+            }
+            else
+                Code.Push( context->TRUE() ? 1 : 0 );
+        }
+    };
+}  // namespace
+
+//
+// bytecode
+//
+
+size_t prs::compiler::bytecode::Size() const
+{
+    return Bytes.size();
+}
+
+const std::vector<uint8_t>& prs::compiler::bytecode::Get() const
+{
+    return Bytes;
+}
+
+void prs::compiler::bytecode::Op( uint16_t op )
+{
+    Int16( op );
+}
+
+void prs::compiler::bytecode::Int16( uint16_t value )
+{
+    Bytes.push_back( static_cast<uint8_t>( value >> 8 ) );
+    Bytes.push_back( static_cast<uint8_t>( value ) );
+}
+
+void prs::compiler::bytecode::Int32( uint32_t value )
+{
+    Int16( static_cast<uint16_t>( value >> 16 ) );
+    Int16( static_cast<uint16_t>( value ) );
+}
+
+void prs::compiler::bytecode::Push( int32_t value )
+{
+    Op( opcode::Int );
+    Int32( static_cast<uint32_t>( value ) );
+}
+
+void prs::compiler::bytecode::Text( const std::string& text, size_t size )
+{
+    Bytes.insert( Bytes.end(), text.begin(), text.end() );
+    Bytes.resize( Bytes.size() + size - text.size(), 0 );
+}
+
+void prs::compiler::bytecode::Append( const bytecode& other )
+{
+    Bytes.insert( Bytes.end(), other.Bytes.begin(), other.Bytes.end() );
+}
+
+void prs::compiler::bytecode::Patch( size_t position, uint32_t value )
+{
+    for( size_t idx = 0; idx < 4; idx++ )
+        Bytes.at( position + idx ) = static_cast<uint8_t>( value >> ( 24 - idx * 8 ) );
+}
+
+//
+// compiler
+//
+
+prs::compiler::result prs::compiler::Compile( antlr4::tree::ParseTree* tree )
+{
+    result output;
+
+    prs::analysis::table symbols = prs::analysis::table::Build( tree );
+    output.Diagnostics           = prs::analysis::analyzer().Run( symbols, 1 );
+
+    // procedures table keeps order of first appearance, whatever it was
+    std::vector<std::tuple<const prs::analysis::symbol*, bool>> appearances;  // symbol, is import
+    for( const auto& imported : symbols.ProcedureImports )
+        appearances.emplace_back( &imported, true );
+    for( const auto& declaration : symbols.ProcedureDeclarations )
+        appearances.emplace_back( &declaration, false );
+
+    std::sort( appearances.begin(), appearances.end(), []( const auto& left, const auto& right ) {
+        return std::get<0>( left )->Index < std::get<0>( right )->Index;
+    } );
+
+    std::vector<entry>                      procedures;
+    std::unordered_map<std::string, entry*> procedureNames;
+
+    procedures.reserve( appearances.size() + symbols.Procedures.size() );
+    auto add = [&procedures, &procedureNames]( const prs::analysis::symbol& name ) -> entry& {
+        auto it = procedureNames.find( std::string( name.Name ) );
+        if( it != procedureNames.end() )
+            return *it->second;
+
+        procedures.push_back( { name } );
+        procedureNames.emplace( name.Name, &procedures.back() );
+
+        return procedures.back();
+    };
+
+    for( const auto& [name, imported] : appearances )
+    {
+        entry& current = add( *name );
+        current.Imported = current.Imported || imported;
+    }
+
+    for( const auto& body : symbols.Procedures )
+    {
+        entry& current = add( body.Name );
+        if( current.Defined )
+            Error( output.Diagnostics, body.Name, "Procedure <" + std::string( body.Name.Name ) + "> is already defined" );
+
+        current.Defined = true;
+    }
+
+    for( auto& current : procedures )
+    {
+        if( current.Imported && current.Defined )
+            Error( output.Diagnostics, current.Name, "Procedure <" + std::string( current.Name.Name ) + "> is both imported and defined" );
+        else if( !current.Imported && !current.Defined )
+            Error( output.Diagnostics, current.Name, "Procedure <" + std::string( current.Name.Name ) + "> is declared but never defined" );
+
+        current.Flags = current.Imported ? flag::Import : 0;
+    }
+
+    auto isError = []( const prs::analysis::diagnostic& diagnostic ) {
+        return diagnostic.Severity == prs::analysis::severity::Error;
+    };
+
+    if( std::any_of( output.Diagnostics.begin(), output.Diagnostics.end(), isError ) )
+    {
+        prs::analysis::Sort( output.Diagnostics );
+        return output;
+    }
+
+    // identifiers; procedure names first, then imported variables
+    bytecode                                  identifiers;
+    std::unordered_map<std::string, uint32_t> identifierOffsets;
+    auto                                      identifier = [&identifiers, &identifierOffsets]( const std::string& name ) {
+        auto it = identifierOffsets.find( name );
+        if( it != identifierOffsets.end() )
+            return it->second;
+
+        uint16_t size = IdentifierSize( name );
+        identifiers.Int16( size );
+
+        // offset includes section size
+        uint32_t offset = static_cast<uint32_t>( identifiers.Size() + 4 );
+        identifierOffsets.emplace( name, offset );
+        identifiers.Text( name, size );
+
+        return offset;
+    };
+
+    for( const auto& current : procedures )
+        identifier( std::string( current.Name.Name ) );
+
+    std::unordered_map<std::string, variable> globals;
+    for( size_t idx = 0; idx < symbols.Variables.size(); idx++ )
+        globals.emplace( symbols.Variables[idx].Name, variable { storage::Global, static_cast<uint32_t>( idx ) } );
+    for( const auto& imported : symbols.VariableImports )
+        globals.emplace( imported.Name, variable { storage::External, identifier( std::string( imported.Name ) ) } );
+
+    size_t codeStart = HeaderSize + 4 + procedures.size() * ProcedureSize + 4 + identifiers.Size() + 4;
+
+    generator walker( symbols, globals, procedureNames, static_cast<uint32_t>( codeStart ) );
+    walker.Walk( tree );
+
+    if( !walker.Diagnostics.empty() )
+    {
+        std::move( walker.Diagnostics.begin(), walker.Diagnostics.end(), std::back_inserter( output.Diagnostics ) );
+        prs::analysis::Sort( output.Diagnostics );
+        return output;
+    }
+
+    // globals initialization, run once when script is loaded
+    bytecode& code       = walker.Code;
+    uint32_t  initialize = static_cast<uint32_t>( codeStart + code.Size() );
+
+    for( int32_t value : walker.Values )
+        code.Push( value );
+
+    code.Op( opcode::SetGlobal );
+    code.Op( opcode::CriticalDone );
+    code.Op( opcode::StopProg );
+
+    bytecode file;
+    file.Op( opcode::CriticalStart );
+    file.Push( static_cast<int32_t>( initialize ) );
+    file.Op( opcode::Jmp );
+    while( file.Size() < HeaderSize )
+        file.Op( opcode::Noop );
+
+    file.Int32( static_cast<uint32_t>( procedures.size() ) );
+    for( const auto& current : procedures )
+    {
+        file.Int32( identifierOffsets.at( std::string( current.Name.Name ) ) );
+        file.Int32( current.Flags );
+        file.Int32( 0 );  // time
+        file.Int32( 0 );  // condition
+        file.Int32( current.Body );
+        file.Int32( 0 );  // arguments, grammar allows empty list only
+    }
+
+    file.Int32( static_cast<uint32_t>( identifiers.Size() ) );
+    file.Append( identifiers );
+    file.Int32( None );  // strings
+    file.Append( code );
+
+    output.Success = true;
+    output.Bytes   = file.Get();
+
+    prs::analysis::Sort( output.Diagnostics );
+
+    return output;
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "prs.analysis.hpp"
+
+// Fallout .int bytecode backend
+//
+// all values are big-endian; file layout, as read by game engine:
+//   header        42 bytes of start-up code, jumping to globals initialization
+//   procedures    int32 count, then 24 bytes per procedure (name, flags, time, condition, body, arguments)
+//   identifiers   int32 size, then entries (int16 size, zero-terminated name padded to even size)
+//   strings       int32 size, or 0xFFFFFFFF if there are none
+//   code          procedure bodies, globals initialization
+//
+// names are stored as offsets into identifiers section, addresses are offsets from start of file
+//
+// supported constructs are everything grammar allows: procedures, variables, imports, increments, if blocks
+// scripts with semantic errors (prs::analysis) are not compiled
+
+namespace prs::compiler
+{
+    namespace opcode
+    {
+        constexpr uint16_t Noop          = 0x8000;
+        constexpr uint16_t CriticalStart = 0x8002;
+        constexpr uint16_t CriticalDone  = 0x8003;
+        constexpr uint16_t Jmp           = 0x8004;
+        constexpr uint16_t StopProg      = 0x8011;
+        constexpr uint16_t FetchGlobal   = 0x8012;
+        constexpr uint16_t StoreGlobal   = 0x8013;
+        constexpr uint16_t FetchExternal = 0x8014;
+        constexpr uint16_t StoreExternal = 0x8015;
+        constexpr uint16_t PopReturn     = 0x801C;
+        constexpr uint16_t PopBase       = 0x8029;
+        constexpr uint16_t PopToBase     = 0x802A;
+        constexpr uint16_t PushBase      = 0x802B;
+        constexpr uint16_t SetGlobal     = 0x802C;
+        constexpr uint16_t If            = 0x802F;
+        constexpr uint16_t Store         = 0x8031;
+        constexpr uint16_t Fetch         = 0x8032;
+        constexpr uint16_t Add           = 0x8039;
+        constexpr uint16_t Int           = 0xC001;  // followed by int32
+    }  // namespace opcode
+
+    // procedure flags
+    namespace flag
+    {
+        constexpr uint32_t Import = 0x04;
+    }
+
+    constexpr size_t HeaderSize    = 42;
+    constexpr size_t ProcedureSize = 24;
+
+    // big-endian buffer
+    class bytecode
+    {
+    private:
+        std::vector<uint8_t> Bytes = {};
+
+    public:
+        size_t                      Size() const;
+        const std::vector<uint8_t>& Get() const;
+
+        void Op( uint16_t op );
+        void Int16( uint16_t value );
+        void Int32( uint32_t value );
+        void Push( int32_t value );                         // Int opcode with value
+        void Text( const std::string& text, size_t size );  // zero padded, size must be greater than text size
+        void Append( const bytecode& other );
+
+        // overwrites int32 at given position, used for addresses known after code is written
+        void Patch( size_t position, uint32_t value );
+    };
+
+    struct result
+    {
+        bool                                   Success     = false;
+        std::vector<uint8_t>                   Bytes       = {};
+        std::vector<prs::analysis::diagnostic> Diagnostics = {};  // semantic errors and warnings
+    };
+
+    // tree must be created by ssl parser, without syntax errors
+    result Compile( antlr4::tree::ParseTree* tree );
+}  // namespace prs::compiler
@@ -0,0 +1,144 @@
+#include <cstring>
+
+#if defined( __linux__ )
+    #include <linux/perf_event.h>
+    #include <sys/ioctl.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+#endif
+
+#include "prs.counters.hpp"
+
+namespace
+{
+    const std::array<std::string, prs::counters::Count> Names = { "cycles", "instructions", "cache-misses", "branch-misses" };
+
+#if defined( __linux__ )
+    const std::array<uint64_t, prs::counters::Count> Configs = { PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES };
+
+    // user space only, so it works with perf_event_paranoid <= 2
+    int OpenCounter( uint64_t config )
+    {
+        perf_event_attr attr;
+        std::memset( &attr, 0, sizeof( attr ) );
+
+        attr.size           = sizeof( attr );
+        attr.type           = PERF_TYPE_HARDWARE;
+        attr.config         = config;
+        attr.read_format    = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv     = 1;
+
+        return static_cast<int>( syscall( SYS_perf_event_open, &attr, 0, -1, -1, 0 ) );
+    }
+#endif
+}  // namespace
+
+const std::string& prs::counters::Name( counter which )
+{
+    return Names[static_cast<size_t>( which )];
+}
+
+//
+// values
+//
+
+prs::counters::values& prs::counters::values::operator+=( const values& other )
+{
+    for( size_t idx = 0; idx < Count; idx++ )
+        Values[idx] += other.Values[idx];
+
+    return *this;
+}
+
+prs::counters::values prs::counters::values::operator-( const values& other ) const
+{
+    values result;
+
+    // scaled values of multiplexed counters are estimates, and might go backwards
+    for( size_t idx = 0; idx < Count; idx++ )
+        result.Values[idx] = Values[idx] > other.Values[idx] ? Values[idx] - other.Values[idx] : 0;
+
+    return result;
+}
+
+//
+// group
+//
+
+prs::counters::group::group() :
+    Descriptors()
+{
+    Descriptors.fill( -1 );
+}
+
+prs::counters::group::~group()
+{
+    Close();
+}
+
+bool prs::counters::group::Open()
+{
+    Close();
+
+#if defined( __linux__ )
+    for( size_t idx = 0; idx < Count; idx++ )
+        Descriptors[idx] = OpenCounter( Configs[idx] );
+#endif
+
+    return IsAvailable();
+}
+
+bool prs::counters::group::IsAvailable( counter which ) const
+{
+    return Descriptors[static_cast<size_t>( which )] >= 0;
+}
+
+bool prs::counters::group::IsAvailable() const
+{
+    for( int descriptor : Descriptors )
+    {
+        if( descriptor >= 0 )
+            return true;
+    }
+
+    return false;
+}
+
+prs::counters::values prs::counters::group::Read() const
+{
+    values result;
+
+#if defined( __linux__ )
+    for( size_t idx = 0; idx < Count; idx++ )
+    {
+        if( Descriptors[idx] < 0 )
+            continue;
+
+        // value, time enabled, time running
+        std::array<uint64_t, 3> data = {};
+        if( read( Descriptors[idx], data.data(), sizeof( data ) ) != static_cast<ssize_t>( sizeof( data ) ) )
+            continue;
+
+        if( data[2] > 0 && data[2] < data[1] )
+            result.Values[idx] = static_cast<uint64_t>( static_cast<double>( data[0] ) * static_cast<double>( data[1] ) / static_cast<double>( data[2] ) );
+        else
+            result.Values[idx] = data[0];
+    }
+#endif
+
+    return result;
+}
+
+void prs::counters::group::Close()
+{
+#if defined( __linux__ )
+    for( int& descriptor : Descriptors )
+    {
+        if( descriptor >= 0 )
+            close( descriptor );
+
+        descriptor = -1;
+    }
+#endif
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// hardware performance counters of calling thread
+// uses perf_event_open() on Linux; on other platforms, or when perf events are not permitted (containers, kernel.perf_event_paranoid),
+// counters are reported as unavailable and always read as zero
+
+namespace prs::counters
+{
+    enum class counter
+    {
+        Cycles,
+        Instructions,
+        CacheMisses,
+        BranchMisses
+    };
+
+    constexpr size_t Count = 4;
+
+    const std::string& Name( counter which );
+
+    struct values
+    {
+        std::array<uint64_t, Count> Values = {};
+
+        uint64_t Get( counter which ) const { return Values[static_cast<size_t>( which )]; }
+
+        values& operator+=( const values& other );
+        values  operator-( const values& other ) const;
+    };
+
+    // counters are enabled when opened, and counts until group is destroyed
+    class group
+    {
+    private:
+        std::array<int, Count> Descriptors;
+
+    public:
+        group();
+        group( const group& ) = delete;
+        group( group&& )      = delete;
+        ~group();
+
+        group& operator=( const group& ) = delete;
+        group& operator=( group&& )      = delete;
+
+    public:
+        // returns false if none of counters is available
+        bool Open();
+        bool IsAvailable( counter which ) const;
+        bool IsAvailable() const;
+
+        // values are scaled if kernel had to multiplex counters
+        values Read() const;
+
+    private:
+        void Close();
+    };
+}  // namespace prs::counters
@@ -1,10 +1,20 @@
+#include <algorithm>
 #include <csignal>
 #include <cstdio>
 #include <filesystem>
 #include <fstream>
+#include <iostream>
+#include <iterator>
 #include <limits>
 
+#if defined( _WIN32 )
+    #include <fcntl.h>
+    #include <io.h>
+#endif
+
+#include "prs.archive.hpp"
 #include "prs.hpp"
+#include "prs.tree.hpp"
 
 using namespace std::string_literals;
 
@@ -14,43 +24,146 @@ bool prs::base::LoadFile( const std::string& filename )
 {
     UnloadFile();
 
+    RunProbe( phase::Load, true );
+
     std::string content;
 
     if( !prs::LoadFile( filename, content ) )
+    {
+        RunProbe( phase::Load, false );
         return false;
+    }
 
-    GetInput()->load( content );
-    GetInput()->name = filename;
-    GetLexer()->setInputStream( GetInput() );
-    GetTokens()->setTokenSource( GetLexer() );
-    GetParser()->setTokenStream( GetTokens() );
+    GetInput()->Load( std::move( content ), filename );
+    LoadInput();
+
+    RunProbe( phase::Load, false );
 
     return true;
 }
 
+void prs::base::LoadContent( std::string content, const std::string& name )
+{
+    UnloadFile();
+
+    RunProbe( phase::Load, true );
+    GetInput()->Load( std::move( content ), name );
+    LoadInput();
+    RunProbe( phase::Load, false );
+}
+
+void prs::base::LoadBuffer( std::string_view content, const std::string& name )
+{
+    UnloadFile();
+
+    RunProbe( phase::Load, true );
+    GetInput()->Load( content, name );
+    LoadInput();
+    RunProbe( phase::Load, false );
+}
+
 void prs::base::UnloadFile()
 {
     LastParseTree = nullptr;
+    Errors.Clear();
 
     PrintTrace( "UnloadFile=>NeedFill=true" );
     NeedFill = true;
 
-    GetInput()->reset();
-    GetInput()->load( nullptr, 0 );
-    GetInput()->name.clear();
+    GetInput()->Unload();
     GetLexer()->reset();
     GetTokens()->reset();
     GetParser()->reset();
 }
 
+void prs::base::LoadInput()
+{
+    GetLexer()->setInputStream( GetInput() );
+    GetTokens()->setTokenSource( GetLexer() );
+    GetParser()->setTokenStream( GetTokens() );
+}
+
 // work
 
-bool prs::base::Parse( antlr4::atn::PredictionMode mode /* = antlr4::atn::PredictionMode::LL */ )
+void prs::base::FillTokens()
+{
+    if( !NeedFill )
+        return;
+
+    RunProbe( phase::Lexing, true );
+    try
+    {
+        GetTokens()->fill();
+    }
+    catch( const error_limit_exception& )
+    {
+        // tokens stream is incomplete, parser must not use it
+        RunProbe( phase::Lexing, false );
+        PrintTrace( "FillTokens=>ErrorLimitReached=true" );
+        return;
+    }
+    RunProbe( phase::Lexing, false );
+
+    PrintTrace( "FillTokens=>NeedFill=false" );
+    NeedFill = false;
+}
+
+bool prs::base::Parse( antlr4::atn::PredictionMode mode /* = antlr4::atn::PredictionMode::LL */, deadline* until /* = nullptr */ )
 {
     GetParser()->getInterpreter<antlr4::atn::ParserATNSimulator>()->setPredictionMode( mode );
 
+    TimedOut     = false;
+    DepthReached = false;
+    if( until )
+    {
+        DeadlineCheck.SetDeadline( until );
+        GetParser()->addParseListener( &DeadlineCheck );
+    }
+
+    if( DepthCheck.GetLimit() > 0 )
+    {
+        DepthCheck.Reset();
+        GetParser()->addParseListener( &DepthCheck );
+    }
+
+    // if tokens are not filled already, lexing is done lazily, as part of parsing phase
+    RunProbe( phase::Parsing, true );
     LastParseTree = nullptr;
-    LastParseTree = RunParser();
+    try
+    {
+        LastParseTree = RunParser();
+    }
+    catch( const timeout_exception& )
+    {
+        PrintTrace( "Parse=>TimedOut=true" );
+        TimedOut = true;
+    }
+    catch( const error_limit_exception& )
+    {
+        PrintTrace( "Parse=>ErrorLimitReached=true" );
+    }
+    catch( const depth_limit_exception& )
+    {
+        PrintTrace( "Parse=>DepthLimitReached=true" );
+        DepthReached = true;
+    }
+    catch( ... )
+    {
+        // ParseAdaptive() relies on exceptions, probe must see phase ending anyway
+        RunProbe( phase::Parsing, false );
+        RemoveParseListeners();
+
+        throw;
+    }
+    RunProbe( phase::Parsing, false );
+    RemoveParseListeners();
+
+    // tokens stream might be incomplete
+    if( TimedOut || DepthReached || Errors.IsLimitReached() )
+    {
+        LastParseTree = nullptr;
+        return false;
+    }
 
     PrintTrace( "Parse=>NeedFill=false" );
     NeedFill = false;
@@ -58,12 +171,22 @@ bool prs::base::Parse( antlr4::atn::PredictionMode mode /* = antlr4::atn::Predic
     return LastParseTree && GetParser()->getNumberOfSyntaxErrors() == 0;
 }
 
-bool prs::base::ParseAdaptive()
+bool prs::base::ParseAdaptive( deadline* until /* = nullptr */ )
 {
     Ref<antlr4::ANTLRErrorStrategy> oldErrorHandler = GetParser()->getErrorHandler();
 
-    // PrintTrace( "parser->removeErrorListeners()" );
-    // GetParser()->removeErrorListeners();
+    // syntax errors found by SLL stage are found again by LL stage, if SLL fails only because of its weaker prediction there's no error at all;
+    // parser error listeners (console, CollectErrors(), ...) must not see them, or they would be reported twice and counted against error limit
+    // lexer listeners are kept, tokens are not lexed again by LL stage
+    std::vector<antlr4::ANTLRErrorListener*> oldErrorListeners = GetParser()->getErrorListeners();
+    auto                                     restoreListeners  = [this, &oldErrorListeners]() {
+        GetParser()->removeErrorListeners();
+        for( auto* listener : oldErrorListeners )
+            GetParser()->addErrorListener( listener );
+    };
+
+    PrintTrace( "parser->removeErrorListeners()" );
+    GetParser()->removeErrorListeners();
     PrintTrace( "parser->setErrorHandler()" );
     GetParser()->setErrorHandler( std::make_shared<antlr4::BailErrorStrategy>() );
 
@@ -74,7 +197,7 @@ bool prs::base::ParseAdaptive()
         PrintTrace( "prediction=SLL" );
         PrintTrace( "--------------" );
 
-        Parse( antlr4::atn::PredictionMode::SLL );
+        Parse( antlr4::atn::PredictionMode::SLL, until );
     }
     catch( const antlr4::ParseCancellationException& e )
     {
@@ -91,21 +214,127 @@ bool prs::base::ParseAdaptive()
         PrintTrace( "ParseAdaptive=>NeedFill=true" );
         NeedFill = true;
 
-        // PrintTrace( "parser->removeErrorListeners()" );
-        // GetParser()->removeErrorListeners();
-        // PrintTrace( "parser->addErrorListener()" );
-        // GetParser()->addErrorListener( &antlr4::ConsoleErrorListener::INSTANCE );
+        PrintTrace( "parser->addErrorListener()" );
+        restoreListeners();
         PrintTrace( "parser->setErrorHandler()" );
         GetParser()->setErrorHandler( oldErrorHandler );
         GetParser()->setTrace( oldTrace );
 
-        Parse( antlr4::atn::PredictionMode::LL );
+        Parse( antlr4::atn::PredictionMode::LL, until );
+    }
+    catch( ... )
+    {
+        GetParser()->setErrorHandler( oldErrorHandler );
+        restoreListeners();
+
+        throw;
     }
 
+    // instance must stay reusable, whichever way parsing ended
+    GetParser()->setErrorHandler( oldErrorHandler );
+    restoreListeners();
+
     PrintTrace( "parse tree="s + ( GetLastParseTree() ? "OK" : "NULL" ) );
     PrintTrace( "syntax errors="s + std::to_string( GetParser()->getNumberOfSyntaxErrors() ) );
 
-    return GetLastParseTree() && GetParser()->getNumberOfSyntaxErrors() == 0;
+    return !TimedOut && GetLastParseTree() && GetParser()->getNumberOfSyntaxErrors() == 0;
+}
+
+bool prs::base::IsTimedOut()
+{
+    return TimedOut;
+}
+
+void prs::base::SetDepthLimit( size_t limit )
+{
+    DepthCheck.SetLimit( limit );
+}
+
+bool prs::base::IsDepthLimitReached()
+{
+    return DepthReached;
+}
+
+// listeners might not be installed, removing them is no-op then
+void prs::base::RemoveParseListeners()
+{
+    GetParser()->removeParseListener( &DeadlineCheck );
+    DeadlineCheck.SetDeadline( nullptr );
+
+    GetParser()->removeParseListener( &DepthCheck );
+}
+
+//
+// tokens
+//
+
+std::string_view prs::base::GetTokenText( const antlr4::Token* token )
+{
+    // EOF and tokens created by error recovery have range outside of input
+    if( !token || token->getInputStream() != GetInput() )
+        return {};
+
+    return GetInput()->View( token->getStartIndex(), token->getStopIndex() );
+}
+
+std::string_view prs::base::GetTokenName( size_t type )
+{
+    // same as antlr4::dfa::Vocabulary
+    if( type == antlr4::Token::EOF )
+        return "EOF";
+
+    if( TokenNames.empty() )
+    {
+        const antlr4::dfa::Vocabulary& vocabulary = GetLexer()->getVocabulary();
+        for( size_t idx = 0; idx <= vocabulary.getMaxTokenType(); idx++ )
+            TokenNames.push_back( vocabulary.getSymbolicName( idx ) );
+    }
+
+    return type < TokenNames.size() ? TokenNames[type] : std::string_view();
+}
+
+//
+// errors
+//
+
+void prs::base::CollectErrors( size_t limit /* = 0 */ )
+{
+    Errors.SetLimit( limit );
+
+    GetLexer()->removeErrorListeners();
+    GetLexer()->addErrorListener( &Errors );
+    GetParser()->removeErrorListeners();
+    GetParser()->addErrorListener( &Errors );
+}
+
+const std::vector<prs::syntax_error>& prs::base::GetErrors()
+{
+    return Errors.Get();
+}
+
+bool prs::base::IsErrorLimitReached()
+{
+    return Errors.IsLimitReached();
+}
+
+//
+// probes
+//
+
+void prs::base::SetProbe( probe function )
+{
+    Probe = std::move( function );
+}
+
+const prs::probe& prs::base::GetProbe()
+{
+    return Probe;
+}
+
+void prs::base::RunProbe( phase step, bool start )
+{
+    if( Probe )
+        Probe( step, start );
 }
 
 //
@@ -119,31 +348,25 @@ antlr4::tree::ParseTree* prs::base::GetLastParseTree()
 
 std::vector<std::string> prs::base::GetTokensVec( bool full /* = false */, bool insertSpace /* = false */, bool insertNewline /* = false */ )
 {
-    if( NeedFill )
-    {
-        GetTokens()->fill();
-
-        PrintTrace( "GetTokensVec=>NeedFill=false" );
-        NeedFill = false;
-    }
+    FillTokens();
 
     std::vector<std::string> result;
     bool                     lineStart = true;
     for( const auto& token : GetTokens()->getTokens() )
     {
-        size_t      type = token->getType();
-        std::string text = token->getText();
-        std::string name = std::string( GetLexer()->getVocabulary().getSymbolicName( type ) );
+        size_t           type = token->getType();
+        std::string_view text = GetTokenText( token );
+        std::string      name = std::string( GetTokenName( type ) );
 
         if( name.empty() )
-            name += "<\"" + antlrcpp::escapeWhitespace( text, false ) + "\">";
+            name += "<\"" + antlrcpp::escapeWhitespace( token->getText(), false ) + "\">";
 
         if( full )
         {
             name += ":index=" + std::to_string( token->getTokenIndex() );
             name += ",type=" + ( type == std ::numeric_limits<size_t>::max() ? "-1" : std::to_string( type ) );
             name += ",channel=" + std::to_string( token->getChannel() );
-            name += ",file=" + static_cast<antlr4::ANTLRInputStream*>( token->getInputStream() )->name;
+            name += ",file=" + token->getInputStream()->getSourceName();
             name += ",line=" + std::to_string( token->getLine() );
             name += ",column=" + std::to_string( token->getCharPositionInLine() + 1 );
             // name += ",text=" + antlrcpp::escapeWhitespace( text, false );
@@ -182,6 +405,11 @@ void prs::base::PrintTokens( bool full /* = false */ )
         std::cout << '\n';
 }
 
+std::string prs::base::GetTreeString()
+{
+    return LastParseTree ? prs::tree::ToString( LastParseTree, GetParser()->getRuleNames(), true ) : std::string();
+}
+
 void prs::base::PrintTrace( const std::string& prefix, const std::string& message )
 {
     if( !GetParser()->isTrace() || prefix.empty() || message.empty() )
@@ -199,6 +427,267 @@ void prs::base::PrintTrace( const std::string& message )
     PrintTrace( "prs", message );
 }
 
+prs::deadline_listener* prs::base::GetDeadlineListener()
+{
+    return &DeadlineCheck;
+}
+
+//
+// profiling
+//
+
+bool prs::base::IsProfile()
+{
+    return dynamic_cast<antlr4::atn::ProfilingATNSimulator*>( GetParser()->getInterpreter<antlr4::atn::ParserATNSimulator>() ) != nullptr;
+}
+
+void prs::base::SetProfile( bool profile )
+{
+    if( profile == IsProfile() )
+        return;
+
+    // interpreter is replaced, collected statistics are lost when profiling is disabled
+    PrintTrace( "SetProfile="s + ( profile ? "true" : "false" ) );
+    GetParser()->setProfile( profile );
+}
+
+std::vector<prs::decision_profile> prs::base::GetProfile()
+{
+    std::vector<prs::decision_profile> result;
+
+    auto* profiler = dynamic_cast<antlr4::atn::ProfilingATNSimulator*>( GetParser()->getInterpreter<antlr4::atn::ParserATNSimulator>() );
+    if( !profiler )
+        return result;
+
+    const antlr4::atn::ATN&         atn       = GetParser()->getATN();
+    const std::vector<std::string>& ruleNames = GetParser()->getRuleNames();
+
+    for( const auto& info : profiler->getDecisionInfo() )
+    {
+        decision_profile decision;
+
+        decision.Decision             = info.decision;
+        decision.Rule                 = ruleNames[atn.decisionToState[info.decision]->ruleIndex];
+        decision.Invocations          = info.invocations;
+        decision.Time                 = info.timeInPrediction;
+        decision.SLL_TotalLook        = info.SLL_TotalLook;
+        decision.SLL_MaxLook          = info.SLL_MaxLook;
+        decision.LL_TotalLook         = info.LL_TotalLook;
+        decision.LL_MaxLook           = info.LL_MaxLook;
+        decision.LL_Fallback          = info.LL_Fallback;
+        decision.Ambiguities          = info.ambiguities.size();
+        decision.ContextSensitivities = info.contextSensitivities.size();
+        decision.Errors               = info.errors.size();
+
+        result.push_back( std::move( decision ) );
+    }
+
+    return result;
+}
+
+//
+// deadline
+//
+
+prs::deadline::deadline() :
+    Until( clock::time_point::max() )
+{}
+
+prs::deadline::deadline( clock::duration timeout ) :
+    Until( clock::now() + timeout )
+{}
+
+void prs::deadline::Cancel()
+{
+    Cancelled.store( true, std::memory_order_relaxed );
+}
+
+bool prs::deadline::IsExpired() const
+{
+    return Cancelled.load( std::memory_order_relaxed ) || clock::now() >= Until;
+}
+
+void prs::deadline_listener::SetDeadline( deadline* until )
+{
+    Deadline = until;
+    Counter  = 0;
+}
+
+//
+// depth_listener
+//
+
+void prs::depth_listener::SetLimit( size_t limit )
+{
+    Limit = limit;
+}
+
+size_t prs::depth_listener::GetLimit() const
+{
+    return Limit;
+}
+
+void prs::depth_listener::Reset()
+{
+    Depth = 0;
+}
+
+//
+// input
+//
+
+void prs::input::Load( std::string_view content, const std::string& name )
+{
+    Unload();
+
+    // same as antlr4::ANTLRInputStream
+    if( content.starts_with( "\xEF\xBB\xBF" ) )
+        content.remove_prefix( 3 );
+
+    Name  = name;
+    Bytes = content;
+    Ascii = std::all_of( content.begin(), content.end(), []( char ch ) { return static_cast<unsigned char>( ch ) < 0x80; } );
+
+    if( !Ascii )
+    {
+        Decoded.reserve( content.size() );
+        Offsets.reserve( content.size() + 1 );
+
+        DecodeUTF8( content, Decoded, &Offsets );
+        Offsets.push_back( content.size() );
+    }
+}
+
+void prs::input::Load( std::string&& content, const std::string& name )
+{
+    Unload();
+
+    Owned = std::move( content );
+    Load( std::string_view( Owned ), name );
+}
+
+void prs::input::Unload()
+{
+    // Owned is kept, it's replaced by next owned Load()
+    Bytes    = {};
+    Ascii    = true;
+    Position = 0;
+    Decoded.clear();
+    Offsets.clear();
+    Name.clear();
+}
+
+const std::string& prs::input::GetName() const
+{
+    return Name;
+}
+
+void prs::input::consume()
+{
+    if( Position >= size() )
+        throw antlr4::IllegalStateException( "cannot consume EOF" );
+
+    Position++;
+}
+
+void prs::input::seek( size_t index )
+{
+    Position = std::min( index, size() );
+}
+
+std::string prs::input::getSourceName() const
+{
+    return Name.empty() ? antlr4::IntStream::UNKNOWN_SOURCE_NAME : Name;
+}
+
+std::string prs::input::getText( const antlr4::misc::Interval& interval )
+{
+    if( interval.a < 0 || interval.b < 0 || size() == 0 )
+        return {};
+
+    return Text( static_cast<size_t>( interval.a ), std::min( static_cast<size_t>( interval.b ), size() - 1 ) );
+}
+
+std::string prs::input::toString() const
+{
+    return Text( 0, ( Ascii ? Bytes.size() : Decoded.size() ) - 1 );
+}
+
+std::string_view prs::input::View( size_t start, size_t stop ) const
+{
+    if( start > stop || stop >= ( Ascii ? Bytes.size() : Decoded.size() ) )
+        return {};
+
+    if( Ascii )
+        return Bytes.substr( start, stop - start + 1 );
+
+    return Bytes.substr( Offsets[start], Offsets[stop + 1] - Offsets[start] );
+}
+
+// content is valid UTF-8, so text of decoded characters is same as their bytes
+std::string prs::input::Text( size_t start, size_t stop ) const
+{
+    return std::string( View( start, stop ) );
+}
+
+//
+// error_listener
+//
+
+void prs::error_listener::SetLimit( size_t limit )
+{
+    Limit = limit;
+}
+
+size_t prs::error_listener::GetLimit() const
+{
+    return Limit;
+}
+
+bool prs::error_listener::IsLimitReached() const
+{
+    return Limit && Errors.size() >= Limit;
+}
+
+const std::vector<prs::syntax_error>& prs::error_listener::Get() const
+{
+    return Errors;
+}
+
+void prs::error_listener::Clear()
+{
+    Errors.clear();
+}
+
+void prs::error_listener::syntaxError( antlr4::Recognizer* recognizer, antlr4::Token* offendingSymbol, size_t line, size_t charPositionInLine, const std::string& msg, std::exception_ptr /* e */ )
+{
+    // error reported while unwinding after limit is reached
+    if( IsLimitReached() )
+        throw error_limit_exception();
+
+    syntax_error error;
+    error.File    = recognizer->getInputStream() ? recognizer->getInputStream()->getSourceName() : std::string();
+    error.Line    = line;
+    error.Column  = charPositionInLine;
+    error.Message = msg;
+
+    if( offendingSymbol )
+        error.Token = offendingSymbol->getText();
+
+    // expected set is computed only for errors which are kept, it's not cheap
+    auto* parser = dynamic_cast<antlr4::Parser*>( recognizer );
+    if( parser && parser->getState() != antlr4::atn::ATNState::INVALID_STATE_NUMBER )
+    {
+        for( auto type : parser->getExpectedTokens().toList() )
+            error.Expected.push_back( static_cast<size_t>( type ) );
+    }
+
+    Errors.push_back( std::move( error ) );
+
+    if( IsLimitReached() )
+        throw error_limit_exception();
+}
+
 //
 // utils
 //
@@ -207,12 +696,33 @@ bool prs::LoadFile( const std::string& filename, std::string& content )
 {
     content.clear();
 
+    if( filename == "-" )
+    {
+#if defined( _WIN32 )
+        _setmode( _fileno( stdin ), _O_BINARY );
+#endif
+        content.assign( std::istreambuf_iterator<char>( std::cin ), std::istreambuf_iterator<char>() );
+
+        return !std::cin.bad();
+    }
+
     constexpr size_t read_size = 4096;
     std::ifstream    stream( filename, std::ios_base::in | std::ios_base::binary );
     stream.exceptions( std::ios_base::badbit );
 
+    // only paths which cannot be opened are checked for archive entries, regular files are not slowed down
     if( !stream )
-        return false;
+    {
+        std::string archiveName;
+        std::string entryName;
+        if( !prs::archive::Split( filename, archiveName, entryName ) )
+            return false;
+
+        std::shared_ptr<const prs::archive::archive> archive = prs::archive::Get( archiveName );
+        const prs::archive::entry*                   entry   = archive ? archive->Find( entryName ) : nullptr;
+
+        return entry && archive->Read( *entry, content );
+    }
 
     std::string buf( read_size, '\0' );
     while( stream.read( &buf[0], read_size ) )
@@ -221,3 +731,54 @@ bool prs::LoadFile( const std::string& filename, std::string& content )
 
     return true;
 }
+
+size_t prs::DecodeUTF8( std::string_view content, std::u32string& output, std::vector<size_t>* offsets /* = nullptr */, bool partial /* = false */ )
+{
+    size_t idx = 0;
+    while( idx < content.size() )
+    {
+        unsigned char lead = static_cast<unsigned char>( content[idx] );
+        size_t        length;
+        char32_t      code;
+
+        if( lead < 0x80 )
+            length = 1, code = lead;
+        else if( ( lead & 0xE0 ) == 0xC0 )
+            length = 2, code = lead & 0x1F;
+        else if( ( lead & 0xF0 ) == 0xE0 )
+            length = 3, code = lead & 0x0F;
+        else if( ( lead & 0xF8 ) == 0xF0 )
+            length = 4, code = lead & 0x07;
+        else
+            throw antlr4::IllegalArgumentException( "UTF-8 string contains an illegal byte sequence" );
+
+        if( idx + length > content.size() )
+        {
+            if( partial )
+                break;
+
+            throw antlr4::IllegalArgumentException( "UTF-8 string contains an illegal byte sequence" );
+        }
+
+        for( size_t next = 1; next < length; next++ )
+        {
+            unsigned char byte = static_cast<unsigned char>( content[idx + next] );
+            if( ( byte & 0xC0 ) != 0x80 )
+                throw antlr4::IllegalArgumentException( "UTF-8 string contains an illegal byte sequence" );
+
+            code = ( code << 6 ) | ( byte & 0x3F );
+        }
+
+        constexpr char32_t minimum[] = { 0, 0, 0x80, 0x800, 0x10000 };
+        if( code < minimum[length] || code > 0x10FFFF || ( code >= 0xD800 && code <= 0xDFFF ) )
+            throw antlr4::IllegalArgumentException( "UTF-8 string contains an illegal byte sequence" );
+
+        output.push_back( code );
+        if( offsets )
+            offsets->push_back( idx );
+
+        idx += length;
+    }
+
+    return idx;
+}
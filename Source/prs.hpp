@@ -1,18 +1,294 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
 #include <functional>
+#include <stdexcept>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include <antlr4-runtime.h>
 
 namespace prs
 {
-    class base
+    // single prediction decision statistics, as collected by antlr4::atn::ProfilingATNSimulator
+    // values are accumulated over all parsing runs done since profiling has been enabled
+    struct decision_profile
+    {
+        size_t      Decision             = 0;
+        std::string Rule                 = {};
+        long long   Invocations          = 0;
+        long long   Time                 = 0;  // nanoseconds
+        long long   SLL_TotalLook        = 0;
+        long long   SLL_MaxLook          = 0;
+        long long   LL_TotalLook         = 0;
+        long long   LL_MaxLook           = 0;
+        long long   LL_Fallback          = 0;
+        size_t      Ambiguities          = 0;
+        size_t      ContextSensitivities = 0;
+        size_t      Errors               = 0;
+    };
+
+    // work done by base, reported to probe when started and finished
+    enum class phase
+    {
+        Load,
+        Lexing,
+        Parsing,
+        Output
+    };
+
+    using probe = std::function<void( phase step, bool start )>;
+
+    // cooperative cancellation of parsing
+    // can be cancelled from any thread, expiration is checked by lexer and parser at fixed cadence
+    class deadline
+    {
+    public:
+        using clock = std::chrono::steady_clock;
+
+    private:
+        clock::time_point Until;
+        std::atomic<bool> Cancelled = false;
+
+    public:
+        deadline();  // never expires on its own
+        explicit deadline( clock::duration timeout );
+        deadline( const deadline& ) = delete;
+        deadline( deadline&& )      = delete;
+        ~deadline()                 = default;
+
+        deadline& operator=( const deadline& ) = delete;
+        deadline& operator=( deadline&& )      = delete;
+
+    public:
+        void Cancel();
+        bool IsExpired() const;
+    };
+
+    // thrown from lexer and parser when deadline expires, never leaves base::Parse()
+    class timeout_exception : public std::runtime_error
+    {
+    public:
+        timeout_exception() :
+            std::runtime_error( "timed out" ){};
+    };
+
+    // lexer or parser error, as collected by error_listener
+    struct syntax_error
+    {
+        std::string         File     = {};
+        size_t              Line     = 0;
+        size_t              Column   = 0;
+        std::string         Token    = {};  // offending token text, empty for lexer errors
+        std::vector<size_t> Expected = {};  // token types expected by parser, empty for lexer errors
+        std::string         Message  = {};
+    };
+
+    // thrown from lexer and parser when error limit is reached, never leaves base::Parse() or base::FillTokens()
+    class error_limit_exception : public std::runtime_error
+    {
+    public:
+        error_limit_exception() :
+            std::runtime_error( "error limit reached" ){};
+    };
+
+    // collects lexer and parser errors, instead of printing them
+    // as error recovery is the slowest part of parsing broken files, it can be cut short by limiting number of errors
+    class error_listener final : public antlr4::BaseErrorListener
+    {
+    private:
+        std::vector<syntax_error> Errors = {};
+        size_t                    Limit  = 0;  // 0 = unlimited
+
+    public:
+        void   SetLimit( size_t limit );
+        size_t GetLimit() const;
+        bool   IsLimitReached() const;
+
+        const std::vector<syntax_error>& Get() const;
+        void                             Clear();
+
+    public:
+        virtual void syntaxError( antlr4::Recognizer* recognizer, antlr4::Token* offendingSymbol, size_t line, size_t charPositionInLine, const std::string& msg, std::exception_ptr e ) override;
+    };
+
+    // installed as parser listener when Parse() is called with deadline, also used by lexer<>
+    // checks are done on consumed tokens only, as parser cannot be interrupted when entering or leaving rules
+    class deadline_listener final : public antlr4::tree::ParseTreeListener
+    {
+    private:
+        static constexpr size_t Cadence = 256;  // must be power of 2
+
+        deadline* Deadline = nullptr;
+        size_t    Counter  = 0;
+
+    public:
+        void SetDeadline( deadline* until );
+
+        void Check()
+        {
+            if( Deadline && ( ++Counter & ( Cadence - 1 ) ) == 0 && Deadline->IsExpired() )
+                throw timeout_exception();
+        }
+
+    public:
+        virtual void visitTerminal( antlr4::tree::TerminalNode* ) override { Check(); }
+        virtual void visitErrorNode( antlr4::tree::ErrorNode* ) override { Check(); }
+        virtual void enterEveryRule( antlr4::ParserRuleContext* ) override {}
+        virtual void exitEveryRule( antlr4::ParserRuleContext* ) override {}
+    };
+
+    // thrown from parser when nesting limit is reached, never leaves base::Parse()
+    class depth_limit_exception : public std::runtime_error
+    {
+    public:
+        depth_limit_exception() :
+            std::runtime_error( "nesting limit reached" ){};
+    };
+
+    // installed as parser listener when nesting limit is set
+    // generated parser enters rules recursively, deeply nested input would exhaust stack before parse tree is complete
+    class depth_listener final : public antlr4::tree::ParseTreeListener
     {
     private:
-        antlr4::tree::ParseTree* LastParseTree = nullptr;
-        bool                     NeedFill      = true;
+        size_t Limit = 0;
+        size_t Depth = 0;
+
+    public:
+        void   SetLimit( size_t limit );
+        size_t GetLimit() const;
+        void   Reset();
+
+    public:
+        virtual void visitTerminal( antlr4::tree::TerminalNode* ) override {}
+        virtual void visitErrorNode( antlr4::tree::ErrorNode* ) override {}
+        virtual void enterEveryRule( antlr4::ParserRuleContext* ) override
+        {
+            if( ++Depth > Limit )
+                throw depth_limit_exception();
+        }
+        virtual void exitEveryRule( antlr4::ParserRuleContext* ) override { Depth--; }
+    };
+
+    // generated lexer, checking deadline before every token
+    template<typename LexerType>
+    class lexer final : public LexerType
+    {
+    private:
+        deadline_listener* Listener = nullptr;
+
+    public:
+        using LexerType::LexerType;
+
+        void SetListener( deadline_listener* listener ) { Listener = listener; }
+
+        virtual std::unique_ptr<antlr4::Token> nextToken() override
+        {
+            if( Listener )
+                Listener->Check();
+
+            return LexerType::nextToken();
+        }
+    };
+
+    // character stream over borrowed or owned content, replaces antlr4::ANTLRInputStream
+    // same as original, UTF-8 BOM is skipped and invalid UTF-8 is rejected with antlr4::IllegalArgumentException
+    //   ASCII-only content is read in place, without copying
+    //   other content is decoded to code points once, into storage reused by following loads; bytes offsets are kept, so text is still read in place
+    class input final : public antlr4::CharStream
+    {
+    private:
+        std::string         Owned    = {};
+        std::string_view    Bytes    = {};  // content, points to Owned or borrowed buffer; read directly if ASCII-only
+        std::u32string      Decoded  = {};  // content with non-ASCII characters
+        std::vector<size_t> Offsets  = {};  // bytes offset of each decoded character, followed by content size
+        bool                Ascii    = true;
+        size_t              Position = 0;
+        std::string         Name     = {};
+
+    public:
+        void Load( std::string_view content, const std::string& name );  // borrowed, content must stay valid until next Load() or Unload()
+        void Load( std::string&& content, const std::string& name );      // owned
+        void Unload();                                                    // storage capacity is kept
+
+        const std::string& GetName() const;
+
+        // characters range (inclusive) as view into loaded content, valid until next Load() or Unload()
+        std::string_view View( size_t start, size_t stop ) const;
+
+    public:
+        virtual size_t LA( ssize_t i ) override
+        {
+            if( i == 0 )
+                return 0;
+
+            // LA(-1) is previous character
+            ssize_t index = static_cast<ssize_t>( Position ) + ( i < 0 ? i : i - 1 );
+            if( index < 0 || static_cast<size_t>( index ) >= size() )
+                return antlr4::IntStream::EOF;
+
+            return Ascii ? static_cast<size_t>( Bytes[static_cast<size_t>( index )] ) : static_cast<size_t>( Decoded[static_cast<size_t>( index )] );
+        }
+
+        virtual size_t size() override { return Ascii ? Bytes.size() : Decoded.size(); }
+
+        virtual void        consume() override;
+        virtual ssize_t     mark() override { return -1; }
+        virtual void        release( ssize_t ) override {}
+        virtual size_t      index() override { return Position; }
+        virtual void        seek( size_t index ) override;
+        virtual std::string getSourceName() const override;
+        virtual std::string getText( const antlr4::misc::Interval& interval ) override;
+        virtual std::string toString() const override;
+
+    private:
+        std::string Text( size_t start, size_t stop ) const;  // inclusive
+    };
+
+    // front-end shared by parsing backends (see prs.pegtl.hpp), so they can be run and compared by same code
+    class frontend
+    {
+    public:
+        frontend()                  = default;
+        frontend( const frontend& ) = delete;
+        frontend( frontend&& )      = delete;
+        virtual ~frontend()         = default;
+
+        frontend& operator=( const frontend& ) = delete;
+        frontend& operator=( frontend&& )      = delete;
+
+    public:  // files
+        // filename "-" reads standard input
+        virtual bool LoadFile( const std::string& filename ) = 0;
+        virtual void UnloadFile()                            = 0;
+
+    public:  // work
+        // if deadline expires, parsing is aborted and false is returned; IsTimedOut() can be used to tell it apart from syntax errors
+        virtual bool ParseAdaptive( deadline* until = nullptr ) = 0;
+        virtual bool IsTimedOut()                               = 0;
+
+    public:  // diagnostics
+        virtual std::vector<std::string> GetTokensVec( bool full = false, bool insertSpace = false, bool insertNewline = false ) = 0;
+        virtual void                     PrintTokens( bool full = false )                                                         = 0;
+
+        // last parse tree in antlr4::tree::Trees::toStringTree( tree, ruleNames, true ) format, empty if there's none
+        virtual std::string GetTreeString() = 0;
+    };
+
+    class base : public frontend
+    {
+    private:
+        antlr4::tree::ParseTree*      LastParseTree = nullptr;
+        bool                          NeedFill      = true;
+        bool                          TimedOut      = false;
+        probe                         Probe         = {};
+        deadline_listener             DeadlineCheck = {};
+        depth_listener                DepthCheck    = {};
+        bool                          DepthReached  = false;
+        error_listener                Errors        = {};
+        std::vector<std::string_view> TokenNames    = {};  // indexed by token type, filled on first use
 
     public:
         base()              = default;
@@ -24,45 +300,97 @@ namespace prs
         base& operator=( base&& )      = delete;
 
     public:  // lib
-        virtual antlr4::ANTLRInputStream*  GetInput()  = 0;
+        virtual input*                     GetInput()  = 0;
         virtual antlr4::Lexer*             GetLexer()  = 0;
         virtual antlr4::CommonTokenStream* GetTokens() = 0;
         virtual antlr4::Parser*            GetParser() = 0;
         virtual antlr4::tree::ParseTree*   RunParser() = 0;
 
     public:  // files
-        bool LoadFile( const std::string& filename );
-        void UnloadFile();
+        virtual bool LoadFile( const std::string& filename ) override;
+
+        // content is owned by base
+        void LoadContent( std::string content, const std::string& name );
+
+        // content is borrowed, and must stay valid until UnloadFile() or next load; can be loaded again without copying
+        void LoadBuffer( std::string_view content, const std::string& name );
+
+        virtual void UnloadFile() override;
 
     public:  // work
-        bool Parse( antlr4::atn::PredictionMode mode = antlr4::atn::PredictionMode::LL );
-        bool ParseAdaptive();
+        void FillTokens();
+
+        // see ParseAdaptive()
+        bool         Parse( antlr4::atn::PredictionMode mode = antlr4::atn::PredictionMode::LL, deadline* until = nullptr );
+        virtual bool ParseAdaptive( deadline* until = nullptr ) override;
+        virtual bool IsTimedOut() override;
+
+        // parsing is aborted when rules are nested deeper than given level, limit == 0 means no limit
+        // IsDepthLimitReached() can be used to tell it apart from syntax errors
+        void SetDepthLimit( size_t limit );
+        bool IsDepthLimitReached();
+
+    public:  // tokens
+        // token text as view into loaded content, valid until UnloadFile() or next load; nothing is allocated
+        // tokens not backed by input (EOF, created by error recovery) have empty text
+        std::string_view GetTokenText( const antlr4::Token* token );
+
+        // symbolic name of token type, empty if there's none; views are created once per lib, and stays valid for program lifetime
+        std::string_view GetTokenName( size_t type );
+
+    public:  // errors
+        // replaces lexer and parser error listeners (console by default) with one collecting errors of currently loaded file
+        // parsing is aborted when given number of errors is reached, limit == 0 means no limit
+        void                             CollectErrors( size_t limit = 0 );
+        const std::vector<syntax_error>& GetErrors();
+        bool                             IsErrorLimitReached();
+
+    public:  // probes
+        void         SetProbe( probe function );
+        const probe& GetProbe();  // allows chaining probes
+
+        // Output phase is never reported by base itself, callers are responsible for that
+        void RunProbe( phase step, bool start );
 
     public:  // diagnostics
-        antlr4::tree::ParseTree* GetLastParseTree();
-        std::vector<std::string> GetTokensVec( bool full = false, bool insertSpace = false, bool insertNewline = false );
-        void                     PrintTokens( bool full = false );
-        void                     PrintTrace( const std::string& prefix, const std::string& message );
+        antlr4::tree::ParseTree*         GetLastParseTree();
+        virtual std::vector<std::string> GetTokensVec( bool full = false, bool insertSpace = false, bool insertNewline = false ) override;
+        virtual void                     PrintTokens( bool full = false ) override;
+        virtual std::string              GetTreeString() override;
+        void                             PrintTrace( const std::string& prefix, const std::string& message );
+
+    public:  // profiling
+        bool                          IsProfile();
+        void                          SetProfile( bool profile );
+        std::vector<decision_profile> GetProfile();
 
     protected:
-        void PrintTrace( const std::string& message );
+        void               PrintTrace( const std::string& message );
+        deadline_listener* GetDeadlineListener();
+
+    private:
+        void LoadInput();
+        void RemoveParseListeners();
     };
 
     template<typename LexerType, typename ParserType>
     class lib final : public base
     {
     private:
-        antlr4::ANTLRInputStream  Input;
-        LexerType                 Lexer;
+        input                     Input;
+        lexer<LexerType>          Lexer;
         antlr4::CommonTokenStream Tokens;
         ParserType                Parser;
 
     public:
         lib() :
-            Input(), Lexer( &Input ), Tokens( &Lexer ), Parser( &Tokens ){};
+            Input(), Lexer( &Input ), Tokens( &Lexer ), Parser( &Tokens )
+        {
+            Lexer.SetListener( GetDeadlineListener() );
+        };
 
     public:
-        virtual antlr4::ANTLRInputStream*  GetInput() override { return &Input; }
+        virtual input*                     GetInput() override { return &Input; }
         virtual LexerType*                 GetLexer() override { return &Lexer; }
         virtual antlr4::CommonTokenStream* GetTokens() override { return &Tokens; }
         virtual ParserType*                GetParser() override { return &Parser; }
@@ -71,5 +399,11 @@ namespace prs
 
     // utils
 
+    // filename "-" reads standard input, <archive.dat>/<entry> reads archive entry (see prs.archive.hpp)
     bool LoadFile( const std::string& filename, std::string& content );
+
+    // strict decoding, rejects overlong sequences, surrogates and code points above U+10FFFF with antlr4::IllegalArgumentException
+    // code points are appended to output, and their bytes offsets to offsets (if given)
+    // if partial, incomplete sequence at the end of content is left for next call; returns number of bytes decoded
+    size_t DecodeUTF8( std::string_view content, std::u32string& output, std::vector<size_t>* offsets = nullptr, bool partial = false );
 }  // namespace prs
@@ -0,0 +1,78 @@
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+
+#include "prs.intern.hpp"
+
+namespace
+{
+    size_t ShardOf( std::string_view name )
+    {
+        return std::hash<std::string_view>{}( name ) % prs::intern::pool::Shards;
+    }
+}  // namespace
+
+// index keys are views of stored names, so they can be returned as they are
+prs::intern::name prs::intern::pool::Intern( std::string_view text )
+{
+    size_t index = ShardOf( text );
+    shard& data  = Data[index];
+
+    {
+        std::shared_lock<std::shared_mutex> lock( data.Lock );
+
+        auto it = data.Index.find( text );
+        if( it != data.Index.end() )
+            return { it->second, it->first };
+    }
+
+    std::unique_lock<std::shared_mutex> lock( data.Lock );
+
+    // another thread could add same name between locks
+    auto it = data.Index.find( text );
+    if( it != data.Index.end() )
+        return { it->second, it->first };
+
+    id result = static_cast<id>( data.Names.size() * Shards + index );
+    data.Names.emplace_back( text );
+    data.Index.emplace( data.Names.back(), result );
+
+    return { result, data.Names.back() };
+}
+
+bool prs::intern::pool::Find( std::string_view name, id& result ) const
+{
+    const shard&                        data = Data[ShardOf( name )];
+    std::shared_lock<std::shared_mutex> lock( data.Lock );
+
+    auto it = data.Index.find( name );
+    if( it == data.Index.end() )
+        return false;
+
+    result = it->second;
+    return true;
+}
+
+std::string_view prs::intern::pool::Get( id name ) const
+{
+    const shard&                        data = Data[name % Shards];
+    std::shared_lock<std::shared_mutex> lock( data.Lock );
+
+    size_t index = name / Shards;
+    if( index >= data.Names.size() )
+        throw std::out_of_range( "prs::intern::pool::Get() unknown id" );
+
+    return data.Names[index];
+}
+
+size_t prs::intern::pool::Size() const
+{
+    size_t result = 0;
+    for( const auto& data : Data )
+    {
+        std::shared_lock<std::shared_mutex> lock( data.Lock );
+        result += data.Names.size();
+    }
+
+    return result;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// identifiers interning
+// each distinct name is stored once and gets small integer id, so names can be compared and hashed as integers;
+// ids and views returned by pool stays valid until pool is destroyed
+//
+// pool is thread-safe, and meant to be shared by all files of a batch; it's split into shards by name hash,
+// so threads interning different names rarely waits for each other, and already known names takes shared lock only
+
+namespace prs::intern
+{
+    using id = uint32_t;
+
+    // result of pool::Intern(), view points to name stored in pool
+    struct name
+    {
+        id               Id   = 0;
+        std::string_view Text = {};
+    };
+
+    class pool
+    {
+    public:
+        static constexpr size_t Shards = 16;
+
+    private:
+        // deque does not move elements when growing, so views used as keys stays valid
+        struct shard
+        {
+            mutable std::shared_mutex                Lock;
+            std::deque<std::string>                  Names = {};
+            std::unordered_map<std::string_view, id> Index = {};
+        };
+
+        std::array<shard, Shards> Data = {};
+
+    public:
+        pool()              = default;
+        pool( const pool& ) = delete;
+        pool( pool&& )      = delete;
+        ~pool()             = default;
+
+        pool& operator=( const pool& ) = delete;
+        pool& operator=( pool&& )      = delete;
+
+    public:
+        // ids are dense within shard, id = index * Shards + shard
+        // name is copied only if it's new, and shard is locked once if it's already known
+        name Intern( std::string_view text );
+
+        // does not add name; returns false if name was never interned
+        bool Find( std::string_view name, id& result ) const;
+
+        // id must be returned by this pool
+        std::string_view Get( id name ) const;
+
+        size_t Size() const;
+    };
+}  // namespace prs::intern
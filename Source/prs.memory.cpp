@@ -0,0 +1,59 @@
+#include <atomic>
+
+#if defined( _WIN32 )
+    #include <windows.h>
+    #include <psapi.h>
+#else
+    #include <sys/resource.h>
+#endif
+
+#include "prs.memory.hpp"
+
+namespace
+{
+    std::atomic<bool>   Hooked      = false;
+    std::atomic<size_t> Allocations = 0;
+    std::atomic<size_t> Bytes       = 0;
+}  // namespace
+
+void prs::memory::SetHooked()
+{
+    Hooked.store( true, std::memory_order_relaxed );
+}
+
+void prs::memory::Count( size_t size )
+{
+    Allocations.fetch_add( 1, std::memory_order_relaxed );
+    Bytes.fetch_add( size, std::memory_order_relaxed );
+}
+
+bool prs::memory::IsHooked()
+{
+    return Hooked.load( std::memory_order_relaxed );
+}
+
+prs::memory::stats prs::memory::Get()
+{
+    return { Allocations.load( std::memory_order_relaxed ), Bytes.load( std::memory_order_relaxed ) };
+}
+
+size_t prs::memory::PeakRSS()
+{
+#if defined( _WIN32 )
+    PROCESS_MEMORY_COUNTERS counters;
+    if( !GetProcessMemoryInfo( GetCurrentProcess(), &counters, sizeof( counters ) ) )
+        return 0;
+
+    return counters.PeakWorkingSetSize;
+#else
+    rusage usage;
+    if( getrusage( RUSAGE_SELF, &usage ) != 0 )
+        return 0;
+
+    #if defined( __APPLE__ )
+    return static_cast<size_t>( usage.ru_maxrss );
+    #else
+    return static_cast<size_t>( usage.ru_maxrss ) * 1024;
+    #endif
+#endif
+}
@@ -0,0 +1,41 @@
+#include <cstdlib>
+#include <new>
+
+#include "prs.memory.hpp"
+
+// global operator new replacement, used by --memstats
+// must be compiled directly into executable, see PRS_MEMORY_HOOK in CMakeLists.txt
+
+namespace
+{
+    struct registration
+    {
+        registration()
+        {
+            prs::memory::SetHooked();
+        }
+    } Registration;
+}  // namespace
+
+// remaining replaceable forms (arrays, nothrow, sized delete) forwards to these by default
+// aligned forms are not replaced, and are not counted
+
+void* operator new( std::size_t size )
+{
+    prs::memory::Count( size );
+
+    if( void* ptr = std::malloc( size ? size : 1 ) )
+        return ptr;
+
+    throw std::bad_alloc();
+}
+
+void operator delete( void* ptr ) noexcept
+{
+    std::free( ptr );
+}
+
+void operator delete( void* ptr, std::size_t /* size */ ) noexcept
+{
+    std::free( ptr );
+}
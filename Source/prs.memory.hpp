@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+
+// allocation accounting
+// counters are updated by global operator new replacement (see prs.memory.hook.cpp), which is compiled only into executables reporting memory statistics;
+// programs linking prs library without it pays nothing
+
+namespace prs::memory
+{
+    struct stats
+    {
+        size_t Allocations = 0;
+        size_t Bytes       = 0;  // total requested, frees are not subtracted
+    };
+
+    // returns false if operator new replacement is not linked in, all counters stays at zero
+    bool IsHooked();
+
+    // used by operator new replacement only
+    void SetHooked();
+    void Count( size_t size );
+
+    stats Get();
+
+    // peak resident set size of current process, in bytes; returns 0 if not available on current platform
+    size_t PeakRSS();
+}  // namespace prs::memory
@@ -0,0 +1,360 @@
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <string_view>
+#include <thread>
+
+#include "prs.parallel.hpp"
+
+namespace
+{
+    bool IsIdentifierHead( char c )
+    {
+        return ( c >= 'A' && c <= 'Z' ) || ( c >= 'a' && c <= 'z' ) || c == '$' || c == '&';
+    }
+
+    bool IsIdentifierTail( char c )
+    {
+        return ( c >= 'A' && c <= 'Z' ) || ( c >= 'a' && c <= 'z' ) || ( c >= '0' && c <= '9' );
+    }
+
+    // results of single chunk, before stitching
+    struct part
+    {
+        bool                                   Success     = false;
+        bool                                   TimedOut    = false;
+        std::vector<prs::parallel::token>      Tokens      = {};
+        std::vector<prs::parallel::diagnostic> Diagnostics = {};
+    };
+
+    // translates chunk-relative position into input position
+    void Translate( const prs::parallel::chunk& chunk, size_t& line, size_t& column )
+    {
+        if( line == 1 )
+            column += chunk.Column;
+
+        line += chunk.Line - 1;
+    }
+
+    // input shared by all workers parsing it
+    struct task
+    {
+        const std::string&                       Content;
+        const std::vector<prs::parallel::chunk>& Chunks;
+        std::vector<part>&                       Parts;
+        std::atomic<size_t>                      NextChunk;
+        prs::deadline*                           Until;
+        const prs::parallel::visitor&            Visit;
+    };
+
+    // parses chunks until there's none left
+    void ParseChunks( prs::base& base, task& input )
+    {
+        prs::parallel::collector errors;
+
+        base.GetLexer()->removeErrorListeners();
+        base.GetLexer()->addErrorListener( &errors );
+        base.GetParser()->removeErrorListeners();
+        base.GetParser()->addErrorListener( &errors );
+
+        for( size_t idx = input.NextChunk++; idx < input.Chunks.size(); idx = input.NextChunk++ )
+        {
+            const prs::parallel::chunk& current = input.Chunks[idx];
+            part&                       output  = input.Parts[idx];
+
+            errors.Clear();
+            base.LoadBuffer( std::string_view( input.Content ).substr( current.Offset, current.Size ), "chunk." + std::to_string( idx ) );
+
+            output.Success  = base.ParseAdaptive( input.Until );
+            output.TimedOut = base.IsTimedOut();
+
+            base.FillTokens();
+            for( const auto& token : base.GetTokens()->getTokens() )
+                output.Tokens.push_back( { token->getType(), token->getTokenIndex(), token->getLine(), token->getCharPositionInLine(), token->getText() } );
+
+            output.Diagnostics = std::move( errors.Get() );
+
+            if( input.Visit )
+                input.Visit( idx, current, base );
+        }
+
+        base.GetLexer()->removeErrorListener( &errors );
+        base.GetParser()->removeErrorListener( &errors );
+    }
+
+    void Stitch( prs::parallel::result& result, std::vector<part>& parts )
+    {
+        result.Success = true;
+        for( size_t idx = 0; idx < parts.size(); idx++ )
+        {
+            const prs::parallel::chunk& current = result.Chunks[idx];
+            part&                       output  = parts[idx];
+
+            result.Success  = result.Success && output.Success;
+            result.TimedOut = result.TimedOut || output.TimedOut;
+
+            for( auto& token : output.Tokens )
+            {
+                // each chunk ends with its own EOF, only last one is kept
+                if( token.Type == antlr4::Token::EOF && idx + 1 < parts.size() )
+                    continue;
+
+                token.Index = result.Tokens.size();
+                Translate( current, token.Line, token.Column );
+                result.Tokens.push_back( std::move( token ) );
+            }
+
+            for( auto& error : output.Diagnostics )
+            {
+                Translate( current, error.Line, error.Column );
+                result.Diagnostics.push_back( std::move( error ) );
+            }
+        }
+    }
+}  // namespace
+
+//
+// collector
+//
+
+void prs::parallel::collector::syntaxError( antlr4::Recognizer* /* recognizer */, antlr4::Token* /* offendingSymbol */, size_t line, size_t charPositionInLine, const std::string& msg, std::exception_ptr /* e */ )
+{
+    Diagnostics.push_back( { line, charPositionInLine, msg } );
+}
+
+std::vector<prs::parallel::diagnostic>& prs::parallel::collector::Get()
+{
+    return Diagnostics;
+}
+
+void prs::parallel::collector::Clear()
+{
+    Diagnostics.clear();
+}
+
+//
+// threads
+//
+
+size_t prs::parallel::Threads( size_t threads, size_t tasks )
+{
+    if( threads == 0 )
+        threads = std::max<size_t>( std::thread::hardware_concurrency(), 1 );
+
+    return std::max<size_t>( std::min( threads, tasks ), 1 );
+}
+
+void prs::parallel::Pool( size_t threads, const std::function<void()>& worker )
+{
+    std::vector<std::thread> workers;
+    for( size_t idx = 1; idx < threads; idx++ )
+        workers.emplace_back( worker );
+
+    worker();
+
+    for( auto& thread : workers )
+        thread.join();
+}
+
+//
+// split
+//
+
+std::vector<prs::parallel::chunk> prs::parallel::Split( const std::string& content, size_t chunkSize )
+{
+    std::vector<chunk> result;
+    chunk              current;
+
+    size_t depth     = 0;
+    size_t line      = 1;
+    size_t lineStart = 0;
+
+    // called right after last character of global_scope
+    auto boundary = [&]( size_t pos ) {
+        if( pos - current.Offset < chunkSize || pos >= content.size() )
+            return;
+
+        current.Size = pos - current.Offset;
+        result.push_back( current );
+
+        current        = {};
+        current.Offset = pos;
+        current.Line   = line;
+        current.Column = pos - lineStart;
+    };
+
+    size_t pos = 0;
+    while( pos < content.size() )
+    {
+        char c    = content[pos];
+        char next = pos + 1 < content.size() ? content[pos + 1] : '\0';
+
+        if( c == '\n' )
+        {
+            pos++;
+            line++;
+            lineStart = pos;
+        }
+        else if( c == '/' && next == '/' )  // COMMENT_SHORT
+        {
+            pos = std::min( content.find_first_of( "\r\n", pos ), content.size() );
+        }
+        else if( c == '/' && next == '*' )  // COMMENT_MEDIUM, COMMENT_LONG, or COMMENT_LONG_PREFIX if unfinished
+        {
+            size_t end = content.find( "*/", pos + 2 );
+            if( end == std::string::npos )
+            {
+                pos += 2;
+                continue;
+            }
+
+            for( end += 2; pos < end; pos++ )
+            {
+                if( content[pos] == '\n' )
+                {
+                    line++;
+                    lineStart = pos + 1;
+                }
+            }
+        }
+        else if( IsIdentifierHead( c ) )  // IDENTIFIER or keyword
+        {
+            size_t start = pos;
+            for( pos++; pos < content.size() && IsIdentifierTail( content[pos] ); pos++ )
+                ;
+
+            std::string_view word( content.data() + start, pos - start );
+            if( word == "begin" )
+                depth++;
+            else if( word == "end" && depth > 0 && --depth == 0 )
+                boundary( pos );
+        }
+        else if( c == ';' )
+        {
+            pos++;
+            if( depth == 0 )
+                boundary( pos );
+        }
+        else
+            pos++;
+    }
+
+    current.Size = content.size() - current.Offset;
+    result.push_back( current );
+
+    return result;
+}
+
+//
+// parse
+//
+
+prs::parallel::result prs::parallel::Parse( const std::string& content, const factory& create, size_t chunkSize, size_t threads /* = 0 */, deadline* until /* = nullptr */, const visitor& visit /* = {} */ )
+{
+    result result;
+    result.Chunks = Split( content, chunkSize );
+
+    std::vector<part> parts( result.Chunks.size() );
+    task              input { content, result.Chunks, parts, 0, until, visit };
+
+    Pool( Threads( threads, result.Chunks.size() ), [&]() {
+        std::unique_ptr<prs::base> base = create();
+        ParseChunks( *base, input );
+    } );
+
+    Stitch( result, parts );
+
+    return result;
+}
+
+//
+// pool
+//
+
+prs::parallel::pool::pool( factory create, size_t threads /* = 0 */ ) :
+    Create( std::move( create ) )
+{
+    threads = Threads( threads, std::numeric_limits<size_t>::max() );
+    for( size_t idx = 0; idx < threads; idx++ )
+        Workers.emplace_back( &pool::Worker, this );
+}
+
+prs::parallel::pool::~pool()
+{
+    {
+        std::lock_guard<std::mutex> lock( Mutex );
+        Stopping = true;
+    }
+
+    Wake.notify_all();
+    for( auto& thread : Workers )
+        thread.join();
+}
+
+size_t prs::parallel::pool::GetThreads() const
+{
+    return Workers.size();
+}
+
+prs::parallel::result prs::parallel::pool::Parse( const std::string& content, size_t chunkSize, deadline* until /* = nullptr */, const visitor& visit /* = {} */ )
+{
+    result result;
+    result.Chunks = Split( content, chunkSize );
+
+    std::vector<part> parts( result.Chunks.size() );
+    task              input { content, result.Chunks, parts, 0, until, visit };
+
+    std::lock_guard<std::mutex> busy( Busy );
+    Run( [&input]( prs::base& base ) {
+        ParseChunks( base, input );
+    } );
+
+    Stitch( result, parts );
+
+    return result;
+}
+
+void prs::parallel::pool::Run( const job& work )
+{
+    std::unique_lock<std::mutex> lock( Mutex );
+
+    Job     = &work;
+    Running = Workers.size();
+    Generation++;
+
+    Wake.notify_all();
+    Done.wait( lock, [this]() { return Running == 0; } );
+
+    Job = nullptr;
+}
+
+void prs::parallel::pool::Worker()
+{
+    // created by worker thread, as antlr might keep DFA cache per thread (see PRS_ANTLR_THREAD_LOCAL_CACHE)
+    std::unique_ptr<prs::base> base;
+    size_t                     generation = 0;
+
+    while( true )
+    {
+        const job* work = nullptr;
+        {
+            std::unique_lock<std::mutex> lock( Mutex );
+            Wake.wait( lock, [&]() { return Stopping || Generation != generation; } );
+
+            if( Stopping )
+                return;
+
+            generation = Generation;
+            work       = Job;
+        }
+
+        if( !base )
+            base = Create();
+
+        ( *work )( *base );
+
+        std::lock_guard<std::mutex> lock( Mutex );
+        if( --Running == 0 )
+            Done.notify_one();
+    }
+}
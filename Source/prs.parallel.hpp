@@ -0,0 +1,125 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "prs.hpp"
+
+// parallel parsing of single input
+// input is split at top-level global_scope boundaries, found by linear pre-scan mirroring FalloutScriptLexer
+// (comments, identifiers/keywords, begin/end nesting); as ssl rule is global_scope*, every chunk is valid on its own
+// if and only if whole input is valid, so result always matches serial parsing
+
+namespace prs::parallel
+{
+    // position of chunk inside original input
+    // Column is counted in bytes, which differs from antlr for non-ASCII characters in first line of chunk
+    struct chunk
+    {
+        size_t Offset = 0;
+        size_t Size   = 0;
+        size_t Line   = 1;
+        size_t Column = 0;
+    };
+
+    struct diagnostic
+    {
+        size_t      Line    = 0;
+        size_t      Column  = 0;
+        std::string Message = {};
+    };
+
+    struct token
+    {
+        size_t      Type   = 0;
+        size_t      Index  = 0;
+        size_t      Line   = 0;
+        size_t      Column = 0;
+        std::string Text   = {};
+    };
+
+    struct result
+    {
+        bool                    Success     = false;
+        bool                    TimedOut    = false;
+        std::vector<chunk>      Chunks      = {};
+        std::vector<token>      Tokens      = {};  // single EOF token at the end
+        std::vector<diagnostic> Diagnostics = {};  // lexer and parser errors, in input order
+    };
+
+    using factory = std::function<std::unique_ptr<prs::base>()>;
+
+    // called from worker thread, after chunk is parsed and before lib instance is reused
+    using visitor = std::function<void( size_t index, const chunk& part, prs::base& base )>;
+
+    // collects lexer and parser errors instead of printing them
+    class collector final : public antlr4::BaseErrorListener
+    {
+    private:
+        std::vector<diagnostic> Diagnostics = {};
+
+    public:
+        virtual void syntaxError( antlr4::Recognizer* recognizer, antlr4::Token* offendingSymbol, size_t line, size_t charPositionInLine, const std::string& msg, std::exception_ptr e ) override;
+
+        std::vector<diagnostic>& Get();
+        void                     Clear();
+    };
+
+    // threads == 0 uses std::thread::hardware_concurrency(); result is never 0 and never greater than number of tasks (unless it's 0)
+    size_t Threads( size_t threads, size_t tasks );
+
+    // runs worker on given number of threads, including calling one; returns when all workers are finished
+    void Pool( size_t threads, const std::function<void()>& worker );
+
+    // splits input into chunks not smaller than given size (except last one)
+    std::vector<chunk> Split( const std::string& content, size_t chunkSize );
+
+    // threads == 0 uses std::thread::hardware_concurrency()
+    // threads and lib instances are created for single call; see pool when parsing more than one input
+    result Parse( const std::string& content, const factory& create, size_t chunkSize, size_t threads = 0, deadline* until = nullptr, const visitor& visit = {} );
+
+    // persistent worker threads, each one owning lib instance created (and destroyed) by that thread
+    // threads, libs and their DFA caches are kept between Parse() calls, so warm-up is paid once per worker instead of once per input
+    class pool final
+    {
+    private:
+        using job = std::function<void( prs::base& base )>;
+
+        factory                  Create     = {};
+        std::vector<std::thread> Workers    = {};
+        std::mutex               Busy       = {};  // serializes Parse() calls
+        std::mutex               Mutex      = {};
+        std::condition_variable  Wake       = {};
+        std::condition_variable  Done       = {};
+        const job*               Job        = nullptr;
+        size_t                   Generation = 0;
+        size_t                   Running    = 0;
+        bool                     Stopping   = false;
+
+    public:
+        // threads == 0 uses std::thread::hardware_concurrency()
+        explicit pool( factory create, size_t threads = 0 );
+        pool( const pool& ) = delete;
+        pool( pool&& )      = delete;
+        ~pool();
+
+        pool& operator=( const pool& ) = delete;
+        pool& operator=( pool&& )      = delete;
+
+    public:
+        size_t GetThreads() const;
+
+        // same as prs::parallel::Parse(); calling thread waits until all chunks are parsed
+        result Parse( const std::string& content, size_t chunkSize, deadline* until = nullptr, const visitor& visit = {} );
+
+    private:
+        // runs job once on every worker, returns when all of them are finished
+        void Run( const job& work );
+        void Worker();
+    };
+}  // namespace prs::parallel
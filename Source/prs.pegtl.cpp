@@ -0,0 +1,6 @@
+#include "prs.pegtl.hpp"
+#include "prs.pegtl.ssl.hpp"
+
+// grammars are instantiated once, instead of in every executable using them
+
+template class prs::pegtl::lib<prs::pegtl::ssl::grammar>;
@@ -0,0 +1,567 @@
+#pragma once
+
+#include <cstddef>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <tao/pegtl.hpp>
+#include <tao/pegtl/contrib/parse_tree.hpp>
+
+#include "prs.hpp"
+
+// compile-time parsing backend
+// grammars are expressed as PEGTL rules mirroring .g4 files, and exposed through lib<Grammar>, which implements prs::frontend
+// characters which antlr lexer cannot recognize are reported and skipped by parser, so verdicts are same as with prs::lib<LexerType,ParserType>
+
+namespace prs::pegtl
+{
+    namespace peg = TAO_PEGTL_NAMESPACE;
+
+    constexpr size_t EOF_TYPE = std::numeric_limits<size_t>::max();
+
+    // base for parser rules
+    // only rules deriving from it (and tokens) are stored in parse tree
+    struct rule
+    {};
+
+    // terminal matching exactly one lexer token
+    template<size_t Type, typename Rule>
+    struct lexeme : Rule
+    {
+        static constexpr size_t type = Type;
+    };
+
+    // terminal as seen by parser; characters matched by Unknown are skipped first, same as antlr lexer drops them before next token
+    // MUST be used through type alias, so actions can be selected with partial specialization
+    template<size_t Type, typename Rule, typename Unknown>
+    struct token : peg::seq<peg::star<Unknown>, lexeme<Type, Rule>>
+    {
+        using lexeme_type = lexeme<Type, Rule>;
+    };
+
+    template<typename Rule>
+    struct is_token : std::false_type
+    {};
+
+    template<size_t Type, typename Rule>
+    struct is_token<lexeme<Type, Rule>> : std::true_type
+    {};
+
+    template<typename Rule>
+    constexpr bool is_parser_rule = std::is_base_of_v<rule, Rule>;
+
+    // characters which lexer cannot recognize, as matched by grammar rule; reported and skipped, same as antlr does
+    template<typename Rule>
+    struct unknown : Rule
+    {};
+
+    // lexer rule
+    // runs until end of input, tries all tokens in given order (which MUST respect antlr lexer priorities)
+    template<typename Unknown, typename... Tokens>
+    struct lexer : peg::until<peg::eof, peg::sor<typename Tokens::lexeme_type..., unknown<Unknown>>>
+    {};
+
+    struct token_info
+    {
+        size_t Type   = 0;
+        size_t Index  = 0;
+        size_t Start  = 0;
+        size_t Stop   = 0;
+        size_t Line   = 0;
+        size_t Column = 0;
+    };
+
+    struct state
+    {
+        const char*                            Begin    = nullptr;
+        const char*                            Furthest = nullptr;
+        bool                                   Trace    = false;
+        deadline_listener*                     Deadline = nullptr;
+        std::vector<token_info>                Tokens   = {};
+        std::vector<std::pair<size_t, size_t>> Unknown  = {};  // start and stop offsets
+        std::vector<std::string>               Errors   = {};
+    };
+
+    // lexer actions, collecting tokens and unrecognized characters
+
+    template<typename Rule>
+    struct lexer_action : peg::nothing<Rule>
+    {};
+
+    template<size_t Type, typename Rule>
+    struct lexer_action<lexeme<Type, Rule>>
+    {
+        template<typename ActionInput>
+        static void apply( const ActionInput& input, state& st )
+        {
+            // positions are resolved after lexing is done
+            st.Tokens.push_back( { Type, st.Tokens.size(), static_cast<size_t>( input.begin() - st.Begin ), static_cast<size_t>( input.end() - st.Begin ), 0, 0 } );
+        }
+    };
+
+    template<typename Rule>
+    struct lexer_action<unknown<Rule>>
+    {
+        template<typename ActionInput>
+        static void apply( const ActionInput& input, state& st )
+        {
+            st.Unknown.emplace_back( static_cast<size_t>( input.begin() - st.Begin ), static_cast<size_t>( input.end() - st.Begin ) );
+        }
+    };
+
+    // tracks furthest position where any rule failed (used for error reporting), checks deadline, and prints trace if requested
+    template<typename Rule>
+    struct control : peg::normal<Rule>
+    {
+        template<typename ParseInput>
+        static void start( const ParseInput& input, state& st )
+        {
+            if constexpr( is_parser_rule<Rule> )
+            {
+                if( st.Deadline )
+                    st.Deadline->Check();
+            }
+
+            Trace( "enter", input, st );
+        }
+
+        template<typename ParseInput>
+        static void success( const ParseInput& input, state& st )
+        {
+            Trace( "exit", input, st );
+        }
+
+        template<typename ParseInput>
+        static void failure( const ParseInput& input, state& st )
+        {
+            if( !st.Furthest || input.current() > st.Furthest )
+                st.Furthest = input.current();
+
+            Trace( "fail", input, st );
+        }
+
+        // follows antlr trace format, with input offset used instead of lookahead token
+        template<typename ParseInput>
+        static void Trace( std::string_view prefix, const ParseInput& input, state& st )
+        {
+            if constexpr( is_parser_rule<Rule> )
+            {
+                if( st.Trace )
+                    std::cout << prefix << std::string( 8 - prefix.size(), ' ' ) << Name() << ", offset=" << input.current() - st.Begin << '\n';
+            }
+        }
+
+        static std::string_view Name()
+        {
+            std::string_view name = peg::demangle<Rule>();
+            size_t           pos  = name.rfind( "::" );
+
+            return pos == std::string_view::npos ? name : name.substr( pos + 2 );
+        }
+    };
+
+    template<typename Rule>
+    struct tree_selector : std::bool_constant<is_parser_rule<Rule> || is_token<Rule>::value>
+    {};
+
+    //
+    // Grammar requirements
+    //   Grammar::Lexer ................ lexer<...> rule
+    //   Grammar::Parser ............... starting parser rule
+    //   Grammar::Name( size_t type ) .. token symbolic name, must handle EOF_TYPE
+    //
+
+    template<typename Grammar>
+    class lib final : public frontend
+    {
+    private:
+        std::string                            Content        = {};
+        std::string                            Name           = {};
+        state                                  State          = {};
+        std::unique_ptr<peg::parse_tree::node> LastParseTree  = {};
+        deadline_listener                      DeadlineCheck  = {};
+        bool                                   NeedFill       = true;
+        bool                                   TimedOut       = false;
+        bool                                   Trace          = false;
+        bool                                   BuildParseTree = true;
+
+    public:
+        lib()             = default;
+        lib( const lib& ) = delete;
+        lib( lib&& )      = delete;
+        ~lib()            = default;
+
+        lib& operator=( const lib& ) = delete;
+        lib& operator=( lib&& )      = delete;
+
+    public:  // files
+        virtual bool LoadFile( const std::string& filename ) override
+        {
+            UnloadFile();
+
+            if( !prs::LoadFile( filename, Content ) )
+                return false;
+
+            // same as antlr4::ANTLRInputStream
+            if( Content.starts_with( "\xEF\xBB\xBF" ) )
+                Content.erase( 0, 3 );
+
+            Name = filename;
+
+            return true;
+        }
+
+        virtual void UnloadFile() override
+        {
+            LastParseTree.reset();
+
+            PrintTrace( "UnloadFile=>NeedFill=true" );
+            NeedFill = true;
+
+            Content.clear();
+            Name.clear();
+            State = {};
+        }
+
+    public:  // work
+        bool Parse( deadline* until = nullptr )
+        {
+            LastParseTree.reset();
+            TimedOut = false;
+            DeadlineCheck.SetDeadline( until );
+
+            State.Begin    = Content.data();
+            State.Furthest = nullptr;
+            State.Trace    = Trace;
+            State.Deadline = until ? &DeadlineCheck : nullptr;
+            State.Errors.clear();
+
+            peg::memory_input<> input( Content.data(), Content.size(), Name );
+
+            bool result = false;
+            try
+            {
+                if( BuildParseTree )
+                {
+                    LastParseTree = peg::parse_tree::parse<typename Grammar::Parser, tree_selector, peg::nothing, control>( input, State );
+                    result        = LastParseTree != nullptr;
+                }
+                else
+                    result = peg::parse<typename Grammar::Parser, peg::nothing, control>( input, State );
+            }
+            catch( const timeout_exception& )
+            {
+                PrintTrace( "Parse=>TimedOut=true" );
+                TimedOut = true;
+
+                return false;
+            }
+
+            if( !result )
+                State.Errors.push_back( SyntaxError() );
+
+            return result;
+        }
+
+        // PEG parsing has no prediction modes to adapt
+        virtual bool ParseAdaptive( deadline* until = nullptr ) override
+        {
+            return Parse( until );
+        }
+
+        virtual bool IsTimedOut() override
+        {
+            return TimedOut;
+        }
+
+    public:  // settings
+        bool IsTrace()
+        {
+            return Trace;
+        }
+
+        void SetTrace( bool trace )
+        {
+            Trace = trace;
+        }
+
+        void SetBuildParseTree( bool build )
+        {
+            BuildParseTree = build;
+        }
+
+    public:  // diagnostics
+        const peg::parse_tree::node* GetLastParseTree()
+        {
+            return LastParseTree ? LastParseTree->children.front().get() : nullptr;
+        }
+
+        const std::vector<std::string>& GetErrors()
+        {
+            return State.Errors;
+        }
+
+        void FillTokens()
+        {
+            if( !NeedFill )
+                return;
+
+            // lexer errors are not part of parsing result, same as in antlr
+            std::vector<std::string> errors = std::move( State.Errors );
+
+            State.Begin = Content.data();
+            State.Trace = false;
+            State.Tokens.clear();
+            State.Errors.clear();
+            State.Unknown.clear();
+
+            peg::memory_input<> input( Content.data(), Content.size(), Name );
+            peg::parse<typename Grammar::Lexer, lexer_action>( input, State );
+
+            State.Tokens.push_back( { EOF_TYPE, State.Tokens.size(), Content.size(), Content.size(), 0, 0 } );
+
+            // resolve positions in single pass, tokens are already sorted
+            size_t line       = 1;
+            size_t column     = 0;
+            size_t offset     = 0;
+            size_t unknownIdx = 0;
+            for( auto& token : State.Tokens )
+            {
+                for( ; offset < token.Start; offset++ )
+                {
+                    if( unknownIdx < State.Unknown.size() && State.Unknown[unknownIdx].first == offset )
+                    {
+                        const auto& [start, stop] = State.Unknown[unknownIdx];
+
+                        std::cerr << "line " << line << ":" << column << " token recognition error at: '" << Escape( std::string_view( Content ).substr( start, stop - start ) ) << "'\n";
+                        unknownIdx++;
+                    }
+
+                    if( Content[offset] == '\n' )
+                    {
+                        line++;
+                        column = 0;
+                    }
+                    else
+                        column++;
+                }
+
+                token.Line   = line;
+                token.Column = column + 1;
+            }
+
+            State.Errors = std::move( errors );
+
+            PrintTrace( "FillTokens=>NeedFill=false" );
+            NeedFill = false;
+        }
+
+        const std::vector<token_info>& GetTokens()
+        {
+            FillTokens();
+
+            return State.Tokens;
+        }
+
+        std::string_view GetTokenText( const token_info& token )
+        {
+            return std::string_view( Content ).substr( token.Start, token.Stop - token.Start );
+        }
+
+        // output is kept identical to prs::base::GetTokensVec()
+        virtual std::vector<std::string> GetTokensVec( bool full = false, bool insertSpace = false, bool insertNewline = false ) override
+        {
+            std::vector<std::string> result;
+            bool                     lineStart = true;
+            for( const auto& token : GetTokens() )
+            {
+                std::string_view text = GetTokenText( token );
+                std::string      name = std::string( Grammar::Name( token.Type ) );
+
+                if( full )
+                {
+                    name += ":index=" + std::to_string( token.Index );
+                    name += ",type=" + ( token.Type == EOF_TYPE ? "-1" : std::to_string( token.Type ) );
+                    name += ",channel=0";
+                    name += ",file=" + Name;
+                    name += ",line=" + std::to_string( token.Line );
+                    name += ",column=" + std::to_string( token.Column );
+                }
+
+                if( insertSpace && !lineStart )
+                    result.push_back( " " );
+
+                result.push_back( name );
+                lineStart = false;
+
+                // if current token is newline, insert one in output as well
+                if( text == "\r\n" || text == "\n" )
+                {
+                    if( insertNewline )
+                        result.push_back( "\n" );
+                    lineStart = true;
+                }
+            }
+
+            return result;
+        }
+
+        virtual void PrintTokens( bool full = false ) override
+        {
+            std::vector<std::string> tokens = GetTokensVec( full, !full, !full );
+
+            for( const auto& token : tokens )
+            {
+                std::cout << token;
+                if( full )
+                    std::cout << '\n';
+            }
+
+            if( !full )
+                std::cout << '\n';
+        }
+
+        void PrintErrors()
+        {
+            for( const auto& error : GetErrors() )
+                std::cerr << error << '\n';
+        }
+
+        virtual std::string GetTreeString() override
+        {
+            const peg::parse_tree::node* root = GetLastParseTree();
+            if( !root )
+                return {};
+
+            using level = std::pair<const peg::parse_tree::node*, size_t>;
+
+            std::string        result = "(" + NodeText( *root ) + " ";
+            std::vector<level> stack  = { { root, 0 } };
+
+            while( stack.back().second < stack.back().first->children.size() )
+            {
+                auto& [run, childIndex] = stack.back();
+                if( childIndex > 0 )
+                    result += ' ';
+
+                const auto* child = run->children[childIndex].get();
+                if( !child->children.empty() )
+                {
+                    stack.push_back( { child, 0 } );
+
+                    result += '\n';
+                    for( size_t i = 0; i < stack.size(); i++ )
+                        result += "    ";
+
+                    result += "(" + NodeText( *child ) + " ";
+                }
+                else
+                {
+                    result += NodeText( *child );
+                    while( ++stack.back().second == stack.back().first->children.size() )
+                    {
+                        if( stack.size() == 1 )
+                            break;
+
+                        stack.pop_back();
+                        result += ")";
+                    }
+                }
+            }
+
+            return result + ")";
+        }
+
+        void PrintTrace( const std::string& prefix, const std::string& message )
+        {
+            if( !Trace || prefix.empty() || message.empty() )
+                return;
+
+            std::string indented = prefix;
+            if( indented.size() < 7 )
+                indented += std::string( 7 - indented.size(), ' ' );
+
+            std::cout << indented << " " << message << '\n';
+        }
+
+    private:
+        void PrintTrace( const std::string& message )
+        {
+            PrintTrace( "prs", message );
+        }
+
+        std::string NodeText( const peg::parse_tree::node& node )
+        {
+            if( !node.children.empty() )
+            {
+                std::string_view type = node.type;
+                size_t           pos  = type.rfind( "::" );
+
+                return std::string( pos == std::string_view::npos ? type : type.substr( pos + 2 ) );
+            }
+
+            // only EOF can be matched without content
+            if( node.string_view().empty() )
+                return "<EOF>";
+
+            return Escape( node.string_view() );
+        }
+
+        // same as antlrcpp::escapeWhitespace( text, false )
+        static std::string Escape( std::string_view text )
+        {
+            std::string result;
+            for( char c : text )
+            {
+                if( c == '\t' )
+                    result += "\\t";
+                else if( c == '\n' )
+                    result += "\\n";
+                else if( c == '\r' )
+                    result += "\\r";
+                else
+                    result += c;
+            }
+
+            return result;
+        }
+
+        std::string SyntaxError()
+        {
+            const char* at     = State.Furthest ? State.Furthest : Content.data();
+            size_t      offset = static_cast<size_t>( at - Content.data() );
+            size_t      line   = 1;
+            size_t      column = 0;
+
+            for( size_t idx = 0; idx < offset; idx++ )
+            {
+                if( Content[idx] == '\n' )
+                {
+                    line++;
+                    column = 0;
+                }
+                else
+                    column++;
+            }
+
+            std::string result = "line " + std::to_string( line ) + ":" + std::to_string( column ) + " syntax error at ";
+            if( offset >= Content.size() )
+                result += "<EOF>";
+            else
+            {
+                size_t      length = Content.find_first_of( " \t\r\n", offset );
+                std::string text   = Content.substr( offset, length == std::string::npos ? std::string::npos : length - offset );
+
+                result += "'" + text + "'";
+            }
+
+            return result;
+        }
+    };
+}  // namespace prs::pegtl
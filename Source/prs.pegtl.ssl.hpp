@@ -0,0 +1,161 @@
+#pragma once
+
+#include <array>
+#include <string_view>
+
+#include "prs.pegtl.hpp"
+
+// PEG version of grammar/FalloutScriptLexer.g4 and grammar/FalloutScriptParser.g4
+// MUST be kept in sync with .g4 files; rules order in sor<> follows order in which antlr resolves alternatives
+
+// clang-format-sh on
+
+namespace prs::pegtl::ssl
+{
+    namespace peg = TAO_PEGTL_NAMESPACE;
+
+    //
+    // lexer
+    //
+
+    struct identifierHead       : peg::sor<peg::ranges<'A', 'Z', 'a', 'z'>, peg::one<'$', '&'>>{};
+    struct identifierTail       : peg::ranges<'A', 'Z', 'a', 'z', '0', '9'>{};
+
+    // characters which cannot start any token; antlr lexer reports and drops them
+    // character starting a token which is not completed (e.g. ':' not followed by '=') is dropped together with next character,
+    // as antlr lexer consumes it while looking for longer match, and then skips one more when recovering
+    struct tokenHead            : peg::sor<identifierHead, peg::digit, peg::one<'=', ':', '+', '(', ')', ';', '\r', '\n', '\t', ' ', '/', '*'>>{};
+    struct tokenUnfinished      : peg::sor<peg::seq<peg::one<':'>, peg::not_at<peg::one<'='>>>,
+                                           peg::seq<peg::one<'+'>, peg::not_at<peg::one<'+'>>>,
+                                           peg::seq<peg::one<'*'>, peg::not_at<peg::one<'/'>>>,
+                                           peg::seq<peg::one<'/'>, peg::not_at<peg::one<'/', '*'>>>,
+                                           peg::seq<peg::one<'\r'>, peg::not_at<peg::one<'\n'>>>>{};
+    struct unrecognized         : peg::sor<peg::seq<tokenUnfinished, peg::opt<peg::utf8::any>>, peg::seq<peg::not_at<tokenHead>, peg::utf8::any>>{};
+
+    template<size_t Type, typename Rule>
+    using token                 = pegtl::token<Type, Rule, unrecognized>;
+
+    // keywords cannot be followed by characters allowed in identifiers, as lexer would prefer longer IDENTIFIER match
+    template<char... Chars>
+    struct keyword              : peg::seq<peg::string<Chars...>, peg::not_at<identifierTail>>{};
+
+    // token types MUST match antlr generated values
+    using BEGIN                 = token<1, keyword<'b', 'e', 'g', 'i', 'n'>>;
+    using DO                    = token<2, keyword<'d', 'o'>>;
+    using END                   = token<3, keyword<'e', 'n', 'd'>>;
+    using FALSE                 = token<4, keyword<'f', 'a', 'l', 's', 'e'>>;
+    using IF                    = token<5, keyword<'i', 'f'>>;
+    using IMPORT                = token<6, keyword<'i', 'm', 'p', 'o', 'r', 't'>>;
+    using PROCEDURE             = token<7, keyword<'p', 'r', 'o', 'c', 'e', 'd', 'u', 'r', 'e'>>;
+    using THEN                  = token<8, keyword<'t', 'h', 'e', 'n'>>;
+    using TRUE                  = token<9, keyword<'t', 'r', 'u', 'e'>>;
+    using VARIABLE              = token<10, keyword<'v', 'a', 'r', 'i', 'a', 'b', 'l', 'e'>>;
+    using WHILE                 = token<11, keyword<'w', 'h', 'i', 'l', 'e'>>;
+
+    struct keywords             : peg::sor<BEGIN, DO, END, FALSE, IF, IMPORT, PROCEDURE, THEN, TRUE, VARIABLE, WHILE>{};
+
+    using COMMENT_SHORT         = token<12, peg::seq<peg::two<'/'>, peg::star<peg::not_one<'\r', '\n'>>>>;
+    using COMMENT_MEDIUM        = token<13, peg::seq<peg::string<'/', '*'>, peg::until<peg::string<'*', '/'>, peg::not_one<'\r', '\n'>>>>;
+    using COMMENT_LONG          = token<14, peg::seq<peg::string<'/', '*'>, peg::until<peg::string<'*', '/'>>>>;
+    using COMMENT_SHORT_PREFIX  = token<15, peg::two<'/'>>;
+    using COMMENT_LONG_PREFIX   = token<16, peg::string<'/', '*'>>;
+    using COMMENT_LONG_SUFFIX   = token<17, peg::string<'*', '/'>>;
+
+    using IDENTIFIER            = token<18, peg::seq<peg::not_at<keywords>, identifierHead, peg::star<identifierTail>>>;
+
+    using OP_ASSIGN1            = token<19, peg::one<'='>>;
+    using OP_ASSIGN2            = token<20, peg::string<':', '='>>;
+    using OP_INCREASE           = token<21, peg::two<'+'>>;
+
+    using NUMBER                = token<22, peg::plus<peg::digit>>;
+
+    using PAREN_OPEN            = token<23, peg::one<'('>>;
+    using PAREN_CLOSE           = token<24, peg::one<')'>>;
+    using SEMICOLON             = token<25, peg::one<';'>>;
+
+    using EOL_DOS               = token<26, peg::string<'\r', '\n'>>;
+    using EOL_UNIX              = token<27, peg::one<'\n'>>;
+    using TAB                   = token<28, peg::one<'\t'>>;
+    using SPACE                 = token<29, peg::one<' '>>;
+
+    using EOF_                  = token<EOF_TYPE, peg::eof>;
+
+    //
+    // parser
+    //
+
+    struct spaces               : rule, peg::plus<SPACE>{};
+    struct tabs                 : rule, peg::plus<TAB>{};
+    struct eol                  : rule, peg::sor<EOL_DOS, EOL_UNIX>{};
+    struct commentShort         : rule, peg::seq<COMMENT_SHORT>{};
+    struct commentMedium        : rule, peg::seq<COMMENT_MEDIUM>{};
+    struct commentLong          : rule, peg::seq<COMMENT_LONG>{};
+    struct comment              : rule, peg::sor<commentShort, commentMedium, commentLong>{};
+    struct blank                : rule, peg::sor<spaces, tabs, peg::plus<eol>, comment>{};
+
+    struct blanks               : peg::star<blank>{};
+    struct blanksRequired       : peg::plus<blank>{};
+
+    struct ifCondition          : rule, peg::sor<TRUE, FALSE, IDENTIFIER>{};
+
+    struct blockHead            : rule, peg::seq<IF, blanks, peg::opt<PAREN_OPEN>, ifCondition, peg::opt<PAREN_CLOSE>, blanks, THEN>{};
+
+    struct procedure_scope;
+
+    struct blockBody            : rule, peg::sor<peg::seq<BEGIN, blanksRequired, END>, peg::seq<BEGIN, peg::plus<procedure_scope>, END>>{};
+    struct block                : rule, peg::seq<peg::opt<blockHead, blanksRequired>, blockBody>{};
+
+    struct variableHead         : rule, peg::seq<VARIABLE, blanksRequired, IDENTIFIER>{};
+    struct variableOp           : rule, peg::seq<IDENTIFIER, blanks, OP_INCREASE, blanks, SEMICOLON>{};
+    struct variableDeclaration  : rule, peg::sor<peg::seq<variableHead, blanks, peg::sor<OP_ASSIGN2, OP_ASSIGN1>, blanks, NUMBER, blanks, SEMICOLON>, peg::seq<variableHead, blanks, SEMICOLON>>{};
+    struct variableImport       : rule, peg::seq<IMPORT, blanksRequired, variableHead, blanks, SEMICOLON>{};
+
+    struct procedureHead        : rule, peg::seq<PROCEDURE, blanksRequired, IDENTIFIER>{};
+    struct procedureArguments   : rule, peg::seq<PAREN_OPEN, blanks, PAREN_CLOSE>{};
+    struct procedureDeclaration : rule, peg::sor<peg::seq<procedureHead, blanks, procedureArguments, blanks, SEMICOLON>, peg::seq<procedureHead, blanks, SEMICOLON>>{};
+    struct procedureImport      : rule, peg::seq<IMPORT, blanksRequired, procedureDeclaration>{};
+    struct procedureEnd         : rule, peg::seq<END>{};
+    struct procedureBegin       : rule, peg::sor<peg::seq<procedureHead, blanks, procedureArguments, blanks, BEGIN>, peg::seq<procedureHead, blanksRequired, BEGIN>>{};
+    struct procedureBody        : rule, peg::sor<peg::seq<procedureBegin, blanksRequired, procedureEnd>, peg::seq<procedureBegin, peg::plus<procedure_scope>, procedureEnd>>{};
+
+    struct procedure_scope      : rule, peg::sor<blanksRequired, variableDeclaration, variableOp, block>{};
+    struct global_scope         : rule, peg::sor<blanksRequired, variableDeclaration, procedureDeclaration, variableImport, procedureImport, procedureBody>{};
+
+    struct ssl                  : rule, peg::seq<peg::star<global_scope>, EOF_>{};
+    struct prs                  : rule, peg::seq<ssl>{};
+
+    //
+    // front-end
+    //
+
+    struct grammar
+    {
+        using Lexer  = pegtl::lexer<unrecognized,
+                                    COMMENT_SHORT, COMMENT_MEDIUM, COMMENT_LONG, COMMENT_SHORT_PREFIX, COMMENT_LONG_PREFIX, COMMENT_LONG_SUFFIX,
+                                    BEGIN, DO, END, FALSE, IF, IMPORT, PROCEDURE, THEN, TRUE, VARIABLE, WHILE, IDENTIFIER,
+                                    OP_ASSIGN2, OP_ASSIGN1, OP_INCREASE, NUMBER, PAREN_OPEN, PAREN_CLOSE, SEMICOLON,
+                                    EOL_DOS, EOL_UNIX, TAB, SPACE>;
+        using Parser = prs;
+
+        static constexpr std::array<std::string_view, 30> Names = {
+          "", "BEGIN", "DO", "END", "FALSE", "IF", "IMPORT", "PROCEDURE", "THEN", "TRUE", "VARIABLE", "WHILE",
+          "COMMENT_SHORT", "COMMENT_MEDIUM", "COMMENT_LONG", "COMMENT_SHORT_PREFIX", "COMMENT_LONG_PREFIX", "COMMENT_LONG_SUFFIX",
+          "IDENTIFIER", "OP_ASSIGN1", "OP_ASSIGN2", "OP_INCREASE", "NUMBER", "PAREN_OPEN", "PAREN_CLOSE", "SEMICOLON",
+          "EOL_DOS", "EOL_UNIX", "TAB", "SPACE"};
+
+        static std::string_view Name( size_t type )
+        {
+            if( type == EOF_TYPE )
+                return "EOF";
+
+            return type < Names.size() ? Names[type] : "";
+        }
+    };
+
+    using lib = pegtl::lib<grammar>;
+}  // namespace prs::pegtl::ssl
+
+namespace prs::pegtl
+{
+    extern template class lib<ssl::grammar>;
+}
@@ -0,0 +1,213 @@
+#include <algorithm>
+#include <stdexcept>
+
+#include "prs.stream.hpp"
+
+namespace
+{
+    void EncodeUTF8( char32_t code, std::string& output )
+    {
+        if( code < 0x80 )
+            output.push_back( static_cast<char>( code ) );
+        else if( code < 0x800 )
+        {
+            output.push_back( static_cast<char>( 0xC0 | ( code >> 6 ) ) );
+            output.push_back( static_cast<char>( 0x80 | ( code & 0x3F ) ) );
+        }
+        else if( code < 0x10000 )
+        {
+            output.push_back( static_cast<char>( 0xE0 | ( code >> 12 ) ) );
+            output.push_back( static_cast<char>( 0x80 | ( ( code >> 6 ) & 0x3F ) ) );
+            output.push_back( static_cast<char>( 0x80 | ( code & 0x3F ) ) );
+        }
+        else
+        {
+            output.push_back( static_cast<char>( 0xF0 | ( code >> 18 ) ) );
+            output.push_back( static_cast<char>( 0x80 | ( ( code >> 12 ) & 0x3F ) ) );
+            output.push_back( static_cast<char>( 0x80 | ( ( code >> 6 ) & 0x3F ) ) );
+            output.push_back( static_cast<char>( 0x80 | ( code & 0x3F ) ) );
+        }
+    }
+}  // namespace
+
+//
+// input
+//
+
+prs::stream::input::input( size_t window /* = DefaultWindow */ ) :
+    Window( std::max<size_t>( window, 1 ) )
+{}
+
+void prs::stream::input::Open( std::istream& stream, const std::string& name )
+{
+    Stream   = &stream;
+    Name     = name;
+    Start    = 0;
+    Position = 0;
+    Markers  = 0;
+    Marked   = 0;
+    Peak     = 0;
+    Bom      = true;
+    Ended    = false;
+    Pending.clear();
+    Buffer.clear();
+}
+
+const std::string& prs::stream::input::GetName() const
+{
+    return Name;
+}
+
+size_t prs::stream::input::GetPeak() const
+{
+    return Peak;
+}
+
+size_t prs::stream::input::size()
+{
+    throw antlr4::UnsupportedOperationException( "Unbuffered stream cannot know its size" );
+}
+
+void prs::stream::input::consume()
+{
+    if( LA( 1 ) == antlr4::IntStream::EOF )
+        throw antlr4::IllegalStateException( "cannot consume EOF" );
+
+    Position++;
+    Trim();
+}
+
+ssize_t prs::stream::input::mark()
+{
+    if( Markers == 0 )
+        Marked = Position;
+
+    Markers++;
+
+    return -static_cast<ssize_t>( Markers );
+}
+
+void prs::stream::input::release( ssize_t marker )
+{
+    if( marker != -static_cast<ssize_t>( Markers ) )
+        throw antlr4::IllegalStateException( "release() called with an invalid marker." );
+
+    Markers--;
+    Trim();
+}
+
+// seeking forward consumes characters, seeking backward is limited to characters still kept
+void prs::stream::input::seek( size_t index )
+{
+    if( index < Start )
+        throw antlr4::IllegalArgumentException( "cannot seek to character which is no longer buffered" );
+
+    if( index <= Position )
+    {
+        Position = index;
+        return;
+    }
+
+    while( Position < index && LA( 1 ) != antlr4::IntStream::EOF )
+        consume();
+}
+
+std::string prs::stream::input::getSourceName() const
+{
+    return Name.empty() ? antlr4::IntStream::UNKNOWN_SOURCE_NAME : Name;
+}
+
+std::string prs::stream::input::getText( const antlr4::misc::Interval& interval )
+{
+    if( interval.a < 0 || interval.b < interval.a )
+        return {};
+
+    size_t start = static_cast<size_t>( interval.a );
+    size_t stop  = static_cast<size_t>( interval.b );
+    if( start < Start || !Fill( stop ) )
+        throw antlr4::UnsupportedOperationException( "interval is outside of buffered characters" );
+
+    std::string text;
+    text.reserve( stop - start + 1 );
+    for( size_t idx = start - Start; idx <= stop - Start; idx++ )
+        EncodeUTF8( Buffer[idx], text );
+
+    return text;
+}
+
+// content is not kept
+std::string prs::stream::input::toString() const
+{
+    return {};
+}
+
+bool prs::stream::input::Fill( size_t index )
+{
+    while( index >= Start + Buffer.size() && !Ended )
+        Read();
+
+    return index < Start + Buffer.size();
+}
+
+void prs::stream::input::Read()
+{
+    size_t size = Pending.size();
+    Pending.resize( size + Window );
+
+    Stream->read( &Pending[size], static_cast<std::streamsize>( Window ) );
+    Pending.resize( size + static_cast<size_t>( Stream->gcount() ) );
+
+    if( !*Stream )
+        Ended = true;
+
+    // same as antlr4::ANTLRInputStream; window might be smaller than BOM
+    if( Bom )
+    {
+        if( Pending.size() < 3 && !Ended )
+            return;
+
+        if( Pending.starts_with( "\xEF\xBB\xBF" ) )
+            Pending.erase( 0, 3 );
+
+        Bom = false;
+    }
+
+    Pending.erase( 0, DecodeUTF8( Pending, Buffer, nullptr, !Ended ) );
+    Peak = std::max( Peak, Buffer.size() );
+}
+
+// prefix is dropped only when it reaches window size, so characters are moved once per window at most
+void prs::stream::input::Trim()
+{
+    size_t keep = Markers ? std::min( Marked, Position ) : Position;
+    if( keep > 0 )
+        keep--;
+
+    if( keep < Start || keep - Start < Window )
+        return;
+
+    Buffer.erase( 0, keep - Start );
+    Start = keep;
+}
+
+//
+// utils
+//
+
+size_t prs::stream::InvokingState( const antlr4::atn::ATN& atn, size_t parentRule, size_t rule )
+{
+    for( const auto* state : atn.states )
+    {
+        if( !state || state->ruleIndex != parentRule )
+            continue;
+
+        for( size_t idx = 0; idx < state->transitions.size(); idx++ )
+        {
+            const antlr4::atn::Transition* transition = state->transition( idx );
+            if( dynamic_cast<const antlr4::atn::RuleTransition*>( transition ) && transition->target->ruleIndex == rule )
+                return state->stateNumber;
+        }
+    }
+
+    throw std::invalid_argument( "rule is not invoked by parent rule" );
+}
@@ -0,0 +1,204 @@
+#pragma once
+
+#include <istream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "prs.hpp"
+
+// validation of inputs too large to be loaded into memory
+// characters are read from stream in fixed-size windows, tokens are dropped as soon as parser consumes them, and parse tree is not built;
+// parser state is dropped after each top-level rule, so memory use depends on window size and size of largest top-level item, not input size
+//
+// as input cannot be rewound, there is no SLL stage; error recovery cannot look past top-level item it has started in
+
+namespace prs::stream
+{
+    constexpr size_t DefaultWindow = 65536;
+
+    // replaces antlr4::UnbufferedCharStream, which reads wide streams only
+    // same as prs::input, UTF-8 BOM is skipped and invalid UTF-8 is rejected with antlr4::IllegalArgumentException
+    // characters since oldest mark (and one before it, for LA(-1)) are kept, others are dropped once there's at least window of them
+    class input final : public antlr4::CharStream
+    {
+    private:
+        std::istream*  Stream   = nullptr;
+        std::string    Name     = {};
+        size_t         Window   = 0;
+        std::string    Pending  = {};  // bytes read but not decoded yet; incomplete UTF-8 sequence at the end of previous read
+        std::u32string Buffer   = {};  // decoded characters, first one at index Start
+        size_t         Start    = 0;
+        size_t         Position = 0;
+        size_t         Markers  = 0;
+        size_t         Marked   = 0;  // index of oldest mark
+        size_t         Peak     = 0;
+        bool           Bom      = true;  // BOM not checked yet
+        bool           Ended    = false;
+
+    public:
+        explicit input( size_t window = DefaultWindow );
+        input( const input& ) = delete;
+        input( input&& )      = delete;
+        ~input()              = default;
+
+        input& operator=( const input& ) = delete;
+        input& operator=( input&& )      = delete;
+
+    public:
+        // stream must stay valid until input is destroyed or opened again
+        void Open( std::istream& stream, const std::string& name );
+
+        const std::string& GetName() const;
+
+        // largest number of characters kept at once
+        size_t GetPeak() const;
+
+    public:
+        virtual size_t LA( ssize_t i ) override
+        {
+            if( i == 0 )
+                return 0;
+
+            // LA(-1) is previous character
+            ssize_t offset = static_cast<ssize_t>( Position - Start ) + ( i < 0 ? i : i - 1 );
+            if( offset < 0 )
+            {
+                if( Start == 0 )
+                    return antlr4::IntStream::EOF;
+
+                throw antlr4::IndexOutOfBoundsException( "character is no longer buffered" );
+            }
+
+            if( static_cast<size_t>( offset ) >= Buffer.size() && !Fill( Start + static_cast<size_t>( offset ) ) )
+                return antlr4::IntStream::EOF;
+
+            return static_cast<size_t>( Buffer[static_cast<size_t>( offset )] );
+        }
+
+        // always throws antlr4::UnsupportedOperationException, size is not known until stream is fully read
+        virtual size_t size() override;
+
+        virtual void        consume() override;
+        virtual ssize_t     mark() override;
+        virtual void        release( ssize_t marker ) override;
+        virtual size_t      index() override { return Position; }
+        virtual void        seek( size_t index ) override;
+        virtual std::string getSourceName() const override;
+        virtual std::string getText( const antlr4::misc::Interval& interval ) override;  // buffered characters only
+        virtual std::string toString() const override;
+
+    private:
+        bool Fill( size_t index );  // returns false if stream ends before given character
+        void Read();
+        void Trim();
+    };
+
+    struct result
+    {
+        bool                      Success           = false;
+        bool                      TimedOut          = false;
+        bool                      ErrorLimitReached = false;
+        bool                      DepthLimitReached = false;
+        std::vector<syntax_error> Errors            = {};  // lexer and parser errors, in input order; not bounded unless error limit is set
+        size_t                    Characters        = 0;
+        size_t                    Tokens            = 0;
+        size_t                    Items             = 0;  // top-level rules parsed
+        size_t                    Peak              = 0;  // largest number of characters kept at once
+    };
+
+    // ATN state of parent rule which invokes given rule
+    // used as invoking state of top-level rule, so error recovery syncs to start of next item instead of end of input
+    size_t InvokingState( const antlr4::atn::ATN& atn, size_t parentRule, size_t rule );
+
+    // parses stream as sequence of top-level rules, as invoked by parent rule (e.g. `ssl: global_scope* EOF`)
+    // limits (0 = no limit) and deadline works same as in prs::base
+    template<typename LexerType, typename ParserType, typename ParentType, typename RuleType>
+    result Validate( std::istream& stream, const std::string& name, RuleType* ( ParserType::*rule )(), size_t window = DefaultWindow, size_t errorLimit = 0, size_t depthLimit = 0, deadline* until = nullptr )
+    {
+        result                     result;
+        input                      chars( window );
+        lexer<LexerType>           lexer( &chars );
+        antlr4::CommonTokenFactory factory( true );  // characters are gone once token is consumed, text must be copied
+        error_listener             errors;
+        deadline_listener          deadlineCheck;
+        depth_listener             depthCheck;
+
+        chars.Open( stream, name );
+        errors.SetLimit( errorLimit );
+        deadlineCheck.SetDeadline( until );
+        depthCheck.SetLimit( depthLimit );
+
+        lexer.setTokenFactory( &factory );
+        lexer.removeErrorListeners();
+        lexer.addErrorListener( &errors );
+        lexer.SetListener( &deadlineCheck );
+
+        // first token is read by token stream constructor
+        std::unique_ptr<antlr4::UnbufferedTokenStream> tokens;
+        std::unique_ptr<ParserType>                    parser;
+        std::vector<syntax_error>                      invalid;
+
+        try
+        {
+            tokens = std::make_unique<antlr4::UnbufferedTokenStream>( &lexer );
+            parser = std::make_unique<ParserType>( tokens.get() );
+
+            parser->setBuildParseTree( false );
+            parser->removeErrorListeners();
+            parser->addErrorListener( &errors );
+
+            if( until )
+                parser->addParseListener( &deadlineCheck );
+            if( depthLimit )
+                parser->addParseListener( &depthCheck );
+
+            ParentType root( nullptr, antlr4::atn::ATNState::INVALID_STATE_NUMBER );
+            size_t     state = InvokingState( parser->getATN(), root.getRuleIndex(), RuleType( nullptr, 0 ).getRuleIndex() );
+
+            while( tokens->LA( 1 ) != antlr4::Token::EOF )
+            {
+                size_t start = tokens->index();
+
+                // resets parser without touching token stream; contexts created while parsing previous item are freed
+                parser->setTokenStream( tokens.get() );
+                parser->setContext( &root );
+                parser->setState( state );
+                depthCheck.Reset();
+
+                ( parser.get()->*rule )();
+                result.Items++;
+
+                // error recovery might leave offending token in place, it's skipped same as parent rule loop would do
+                if( tokens->index() == start )
+                    tokens->consume();
+            }
+        }
+        catch( const timeout_exception& )
+        {
+            result.TimedOut = true;
+        }
+        catch( const error_limit_exception& )
+        {
+            result.ErrorLimitReached = true;
+        }
+        catch( const depth_limit_exception& )
+        {
+            result.DepthLimitReached = true;
+        }
+        catch( const antlr4::IllegalArgumentException& exception )
+        {
+            invalid.push_back( { name, lexer.getLine(), lexer.getCharPositionInLine(), {}, {}, exception.what() } );
+        }
+
+        result.Errors = errors.Get();
+        result.Errors.insert( result.Errors.end(), invalid.begin(), invalid.end() );
+
+        result.Characters = chars.index();
+        result.Tokens     = tokens ? tokens->index() : 0;
+        result.Peak       = chars.GetPeak();
+        result.Success    = result.Errors.empty() && !result.TimedOut && !result.DepthLimitReached;
+
+        return result;
+    }
+}  // namespace prs::stream
@@ -0,0 +1,139 @@
+#include <algorithm>
+#include <ostream>
+#include <sstream>
+#include <utility>
+
+#include "prs.tree.hpp"
+
+namespace
+{
+    // node, index of next child to visit
+    using level = std::pair<antlr4::tree::ParseTree*, size_t>;
+
+    std::string NodeText( antlr4::tree::ParseTree* node, const std::vector<std::string>& ruleNames )
+    {
+        return antlrcpp::escapeWhitespace( antlr4::tree::Trees::getNodeText( node, ruleNames ), false );
+    }
+}  // namespace
+
+void prs::tree::Walk( antlr4::tree::ParseTreeListener& listener, antlr4::tree::ParseTree* tree )
+{
+    std::vector<level>       stack;
+    antlr4::tree::ParseTree* node = tree;
+
+    while( node )
+    {
+        if( antlr4::tree::ErrorNode::is( *node ) )
+            listener.visitErrorNode( static_cast<antlr4::tree::ErrorNode*>( node ) );
+        else if( antlr4::tree::TerminalNode::is( *node ) )
+            listener.visitTerminal( static_cast<antlr4::tree::TerminalNode*>( node ) );
+        else
+        {
+            auto* context = static_cast<antlr4::ParserRuleContext*>( node );
+
+            listener.enterEveryRule( context );
+            context->enterRule( &listener );
+            stack.emplace_back( node, 0 );
+        }
+
+        // next child of innermost rule, leaving rules without children left
+        node = nullptr;
+        while( !node && !stack.empty() )
+        {
+            auto& [parent, next] = stack.back();
+
+            if( next < parent->children.size() )
+                node = parent->children[next++];
+            else
+            {
+                auto* context = static_cast<antlr4::ParserRuleContext*>( parent );
+
+                context->exitRule( &listener );
+                listener.exitEveryRule( context );
+                stack.pop_back();
+            }
+        }
+    }
+}
+
+void prs::tree::Print( std::ostream& stream, antlr4::tree::ParseTree* tree, const std::vector<std::string>& ruleNames /* = {} */, bool pretty /* = false */ )
+{
+    if( !tree )
+        return;
+    else if( tree->children.empty() )
+    {
+        stream << NodeText( tree, ruleNames );
+        return;
+    }
+
+    std::vector<level> stack = { { tree, 0 } };
+    stream << "(" << NodeText( tree, ruleNames ) << ' ';
+
+    while( !stack.empty() )
+    {
+        auto& [parent, next] = stack.back();
+
+        if( next == parent->children.size() )
+        {
+            stream << ')';
+            stack.pop_back();
+            continue;
+        }
+
+        if( next > 0 )
+            stream << ' ';
+
+        antlr4::tree::ParseTree* child = parent->children[next++];
+        if( child->children.empty() )
+        {
+            stream << NodeText( child, ruleNames );
+            continue;
+        }
+
+        // root is at first level
+        if( pretty )
+        {
+            stream << '\n';
+            for( size_t idx = 0; idx <= stack.size(); idx++ )
+                stream << "    ";
+        }
+
+        stream << "(" << NodeText( child, ruleNames ) << ' ';
+        stack.emplace_back( child, 0 );
+    }
+}
+
+std::string prs::tree::ToString( antlr4::tree::ParseTree* tree, const std::vector<std::string>& ruleNames /* = {} */, bool pretty /* = false */ )
+{
+    std::ostringstream stream;
+    Print( stream, tree, ruleNames, pretty );
+
+    return stream.str();
+}
+
+size_t prs::tree::Depth( antlr4::tree::ParseTree* tree )
+{
+    if( !tree || antlr4::tree::TerminalNode::is( *tree ) )
+        return 0;
+
+    size_t             result = 0;
+    std::vector<level> stack  = { { tree, 0 } };
+
+    while( !stack.empty() )
+    {
+        result = std::max( result, stack.size() );
+
+        auto& [parent, next] = stack.back();
+        if( next == parent->children.size() )
+        {
+            stack.pop_back();
+            continue;
+        }
+
+        antlr4::tree::ParseTree* child = parent->children[next++];
+        if( !antlr4::tree::TerminalNode::is( *child ) )
+            stack.emplace_back( child, 0 );
+    }
+
+    return result;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include <antlr4-runtime.h>
+
+// parse tree traversal without recursion
+// rules nests without bound (block -> blockBody -> procedure_scope -> block), recursive walk over deeply nested input
+// can exhaust stack; functions here keep their position in explicit stack, so depth is limited by memory only
+//
+// parser itself descends recursively, see base::SetDepthLimit()
+
+namespace prs::tree
+{
+    // same order of listener calls as antlr4::tree::ParseTreeWalker
+    void Walk( antlr4::tree::ParseTreeListener& listener, antlr4::tree::ParseTree* tree );
+
+    // same output as antlr4::tree::Trees::toStringTree(), rule names are used if given
+    // pretty output is indented by nesting level, so its size grows with square of depth
+    void        Print( std::ostream& stream, antlr4::tree::ParseTree* tree, const std::vector<std::string>& ruleNames = {}, bool pretty = false );
+    std::string ToString( antlr4::tree::ParseTree* tree, const std::vector<std::string>& ruleNames = {}, bool pretty = false );
+
+    // number of nested rules on longest path, terminals are not counted
+    size_t Depth( antlr4::tree::ParseTree* tree );
+}  // namespace prs::tree
@@ -0,0 +1,7 @@
+Content-Length: 107
+
+{"jsonrpc":"2.0","id":1,"method":"initialize","params":{"processId":null,"rootUri":null,"capabilities":{}}}Content-Length: 52
+
+{"jsonrpc":"2.0","method":"initialized","params":{}}Content-Length: 44
+
+{"jsonrpc":"2.0","id":2,"method":"shutdown"}
\ No newline at end of file
@@ -0,0 +1,23 @@
+Content-Length: 107
+
+{"jsonrpc":"2.0","id":1,"method":"initialize","params":{"processId":null,"rootUri":null,"capabilities":{}}}Content-Length: 52
+
+{"jsonrpc":"2.0","method":"initialized","params":{}}Content-Length: 340
+
+{"jsonrpc":"2.0","method":"textDocument/didOpen","params":{"textDocument":{"uri":"file:///test/session.ssl","languageId":"ssl","version":1,"text":"// zażółć 😀\nvariable counter := 0;\nimport variable imported;\nimport procedure external;\n\nprocedure start;\n\nprocedure start()\nbegin\n    variable local;\n    counter++;\nend\n"}}}Content-Length: 239
+
+{"jsonrpc":"2.0","method":"textDocument/didChange","params":{"textDocument":{"uri":"file:///test/session.ssl","version":2},"contentChanges":[{"range":{"start":{"line":10,"character":4},"end":{"line":10,"character":13}},"text":"counter"}]}}Content-Length: 242
+
+{"jsonrpc":"2.0","method":"textDocument/didChange","params":{"textDocument":{"uri":"file:///test/session.ssl","version":3},"contentChanges":[{"range":{"start":{"line":10,"character":4},"end":{"line":10,"character":12}},"text":"counter++;"}]}}Content-Length: 235
+
+{"jsonrpc":"2.0","method":"textDocument/didChange","params":{"textDocument":{"uri":"file:///test/session.ssl","version":4},"contentChanges":[{"range":{"start":{"line":0,"character":12},"end":{"line":0,"character":12}},"text":" end"}]}}Content-Length: 124
+
+{"jsonrpc":"2.0","id":2,"method":"textDocument/documentSymbol","params":{"textDocument":{"uri":"file:///test/session.ssl"}}}Content-Length: 151
+
+{"jsonrpc":"2.0","id":3,"method":"textDocument/hover","params":{"textDocument":{"uri":"file:///test/session.ssl"},"position":{"line":0,"character":0}}}Content-Length: 111
+
+{"jsonrpc":"2.0","method":"textDocument/didClose","params":{"textDocument":{"uri":"file:///test/session.ssl"}}}Content-Length: 44
+
+{"jsonrpc":"2.0","id":4,"method":"shutdown"}Content-Length: 33
+
+{"jsonrpc":"2.0","method":"exit"}
\ No newline at end of file
@@ -0,0 +1,87 @@
+cmake_minimum_required( VERSION 3.19 FATAL_ERROR )
+
+# checks file written by --trace-events
+#   cmake -DTRACE_EVENTS=<file> -P trace-events.cmake
+#
+# file must be valid JSON in Chrome trace event format; each event must have name, phase, pid and tid,
+# threads must be named before their events, and begin/end events must have timestamps and be balanced on each thread
+
+if( NOT EXISTS "${TRACE_EVENTS}" )
+    message( FATAL_ERROR "Trace events file does not exist\nfile = ${TRACE_EVENTS}" )
+endif()
+
+file( READ "${TRACE_EVENTS}" json )
+
+string( JSON type ERROR_VARIABLE error TYPE "${json}" traceEvents )
+if( error OR NOT "${type}" STREQUAL "ARRAY" )
+    message( FATAL_ERROR "Trace events array not found\n${error}" )
+endif()
+
+string( JSON count LENGTH "${json}" traceEvents )
+if( count EQUAL 0 )
+    message( FATAL_ERROR "Trace events array is empty" )
+endif()
+
+set( threads )
+set( files 0 )
+
+math( EXPR last "${count} - 1" )
+foreach( idx RANGE ${last} )
+    foreach( key IN ITEMS name ph pid tid )
+        string( JSON ${key} ERROR_VARIABLE error GET "${json}" traceEvents ${idx} ${key} )
+        if( error )
+            message( FATAL_ERROR "Event #${idx} has no ${key}\n${error}" )
+        endif()
+    endforeach()
+
+    if( "${ph}" STREQUAL "M" )
+        if( NOT "${name}" STREQUAL "thread_name" OR "${tid}" IN_LIST threads )
+            message( FATAL_ERROR "Event #${idx} is unexpected metadata event\nname = ${name}\ntid = ${tid}" )
+        endif()
+
+        list( APPEND threads "${tid}" )
+        set( depth.${tid} 0 )
+        continue()
+    elseif( NOT "${ph}" MATCHES "^[BE]$" )
+        message( FATAL_ERROR "Event #${idx} has unexpected phase\nph = ${ph}" )
+    elseif( NOT "${tid}" IN_LIST threads )
+        message( FATAL_ERROR "Event #${idx} uses thread which has no name\ntid = ${tid}" )
+    endif()
+
+    string( JSON type ERROR_VARIABLE error TYPE "${json}" traceEvents ${idx} ts )
+    if( error OR NOT "${type}" STREQUAL "NUMBER" )
+        message( FATAL_ERROR "Event #${idx} has no timestamp\n${error}" )
+    endif()
+
+    if( "${ph}" STREQUAL "B" )
+        math( EXPR depth.${tid} "${depth.${tid}} + 1" )
+    else()
+        math( EXPR depth.${tid} "${depth.${tid}} - 1" )
+        if( depth.${tid} LESS 0 )
+            message( FATAL_ERROR "Event #${idx} ends phase which has not started\nname = ${name}\ntid = ${tid}" )
+        endif()
+
+        # name of loaded file is attached to end of load phase
+        if( "${name}" STREQUAL "load" )
+            string( JSON file ERROR_VARIABLE error GET "${json}" traceEvents ${idx} args file )
+            if( error OR "${file}" STREQUAL "" )
+                message( FATAL_ERROR "Event #${idx} has no file name\n${error}" )
+            endif()
+
+            math( EXPR files "${files} + 1" )
+        endif()
+    endif()
+endforeach()
+
+foreach( tid IN LISTS threads )
+    if( NOT depth.${tid} EQUAL 0 )
+        message( FATAL_ERROR "Thread has phases which never ended\ntid = ${tid}" )
+    endif()
+endforeach()
+
+if( files EQUAL 0 )
+    message( FATAL_ERROR "No file has been loaded" )
+endif()
+
+list( LENGTH threads tmp )
+message( STATUS "Trace events: ${count}, threads: ${tmp}, files: ${files}" )